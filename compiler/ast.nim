@@ -11,7 +11,7 @@
 
 import 
   msgs, hashes, nversion, options, strutils, crc, ropes, idents, lists, 
-  intsets, idgen
+  intsets, idgen, tables
 
 type 
   TCallingConvention* = enum 
@@ -286,6 +286,9 @@ const
 
   sfNoRoot* = sfBorrow # a local variable is provably no root so it doesn't
                        # require RC ops
+  sfStackAlloc* = sfNamedParamCall # local 'ref' variable doesn't escape, so
+                                   # its object is allocated on the stack
+  sfSink* = sfInfixCall # parameter takes over the buffer of its argument
 
 const
   # getting ready for the future expr/stmt merge
@@ -357,6 +360,9 @@ type
     nfSem       # node has been checked for semantics
     nfDelegate  # the call can use a delegator
     nfExprCall  # this is an attempt to call a regular expression
+    nfMove      # last read of a string or seq; its buffer can be stolen
+    nfInBounds  # the index of this access is proven to be within bounds
+    nfHasComment # the node has an entry in the comment side table
 
   TNodeFlags* = set[TNodeFlag]
   TTypeFlag* = enum   # keep below 32 for efficiency reasons (now: 23)
@@ -531,7 +537,7 @@ type
   TNodeSeq* = seq[PNode]
   PType* = ref TType
   PSym* = ref TSym
-  TNode*{.final, acyclic.} = object # on a 32bit machine, this takes 32 bytes
+  TNode*{.final, acyclic.} = object # on a 64bit machine, this takes 32 bytes
     when defined(useNodeIds):
       id*: int
     typ*: PType
@@ -550,7 +556,6 @@ type
       ident*: PIdent
     else:
       sons*: TNodeSeq
-    comment*: string
   
   TSymSeq* = seq[PSym]
   TStrTable* = object         # a table[PIdent] of PSym
@@ -785,7 +790,7 @@ const
   ExportableSymKinds* = {skVar, skConst, skProc, skMethod, skType, skIterator, 
     skMacro, skTemplate, skConverter, skEnumField, skLet, skStub}
   PersistentNodeFlags*: TNodeFlags = {nfBase2, nfBase8, nfBase16,
-                                      nfAllConst, nfDelegate}
+                                      nfAllConst, nfDelegate, nfInBounds}
   namePos* = 0
   patternPos* = 1    # empty except for term rewriting macros
   genericParamsPos* = 2
@@ -885,6 +890,37 @@ template `{}=`*(n: PNode, i: int, s: PNode): stmt =
   n.sons[i -| n] = s
   
 var emptyNode* = newNode(nkEmpty)
+
+# Only few nodes carry a comment, so comments are kept in a side table instead
+# of a field that every node would have to pay for. The table is keyed by the
+# node's address; ``nfHasComment`` tells whether the entry belongs to the node.
+# Every node is created with the finalizer 'freeComment', so the entry is
+# removed when the GC frees its node.
+var gComments = initTable[int, string]()
+
+proc freeComment(n: PNode) {.nimcall.} =
+  if nfHasComment in n.flags: gComments.del(cast[int](n))
+
+proc resetComments*() =
+  gComments = initTable[int, string]()
+
+proc comment*(n: PNode): string =
+  if nfHasComment in n.flags: result = gComments[cast[int](n)]
+
+proc `comment=`*(n: PNode, s: string) =
+  if s.isNil:
+    if nfHasComment in n.flags: 
+      excl(n.flags, nfHasComment)
+      gComments.del(cast[int](n))
+  else:
+    incl(n.flags, nfHasComment)
+    gComments[cast[int](n)] = s
+
+proc addComment*(n: PNode, s: string) =
+  ## appends `s` to the comment of `n`.
+  if nfHasComment in n.flags and gComments.hasKey(cast[int](n)):
+    gComments.mget(cast[int](n)).add(s)
+  else: n.comment = s
 # There is a single empty node that is shared! Do not overwrite it!
 
 proc linkTo*(t: PType, s: PSym): PType {.discardable.} =
@@ -954,7 +990,7 @@ when defined(useNodeIds):
   var gNodeId: int
 
 proc newNode(kind: TNodeKind): PNode = 
-  new(result)
+  new(result, freeComment)
   result.kind = kind
   #result.info = UnknownLineInfo() inlined:
   result.info.fileIndex = int32(- 1)
@@ -1001,7 +1037,7 @@ proc newSymNode*(sym: PSym, info: TLineInfo): PNode =
   result.info = info
 
 proc newNodeI(kind: TNodeKind, info: TLineInfo): PNode =
-  new(result)
+  new(result, freeComment)
   result.kind = kind
   result.info = info
   when defined(useNodeIds):
@@ -1012,7 +1048,7 @@ proc newNodeI(kind: TNodeKind, info: TLineInfo): PNode =
     inc gNodeId
 
 proc newNodeI*(kind: TNodeKind, info: TLineInfo, children: int): PNode =
-  new(result)
+  new(result, freeComment)
   result.kind = kind
   result.info = info
   if children > 0:
@@ -1026,7 +1062,7 @@ proc newNodeI*(kind: TNodeKind, info: TLineInfo, children: int): PNode =
 
 proc newNode*(kind: TNodeKind, info: TLineInfo, sons: TNodeSeq = @[],
              typ: PType = nil): PNode =
-  new(result)
+  new(result, freeComment)
   result.kind = kind
   result.info = info
   result.typ = typ
@@ -1237,13 +1273,19 @@ proc rawAddSon*(father, son: PType) =
   add(father.sons, son)
   if not son.isNil: propagateToOwner(father, son)
 
+template initSons(father: PNode) =
+  # most nodes have at most 4 sons: reserve the space with the first
+  # allocation instead of growing an empty seq right away
+  newSeq(father.sons, 4)
+  setLen(father.sons, 0)
+
 proc addSon(father, son: PNode) = 
   assert son != nil
-  if isNil(father.sons): father.sons = @[]
+  if isNil(father.sons): initSons(father)
   add(father.sons, son)
 
 proc addSonNilAllowed*(father, son: PNode) =
-  if isNil(father.sons): father.sons = @[]
+  if isNil(father.sons): initSons(father)
   add(father.sons, son)
 
 proc delSon(father: PNode, idx: int) = 
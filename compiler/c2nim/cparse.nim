@@ -222,7 +222,7 @@ proc skipComAux(p: var TParser, n: PNode) =
   if n != nil and n.kind != nkEmpty: 
     if pfSkipComments notin p.options.flags:
       if n.comment == nil: n.comment = p.tok.s
-      else: add(n.comment, "\n" & p.tok.s)
+      else: addComment(n, "\n" & p.tok.s)
   else: 
     parMessage(p, warnCommentXIgnored, p.tok.s)
   getTok(p)
@@ -106,6 +106,14 @@ proc genArg(p: BProc, n: PNode, param: PSym): PRope =
   elif ccgIntroducedPtr(param):
     initLocExpr(p, n, a)
     result = addrLoc(a)
+  elif sfSink in param.flags and nfMove notin n.flags and
+      n.kind notin nkCallKinds:
+    # the callee takes over the buffer, so it gets a copy of a live value:
+    var tmp: TLoc
+    initLocExpr(p, n, a)
+    getTemp(p, skipTypes(param.typ, abstractInst), tmp)
+    genAssignment(p, tmp, a, {needToCopy})
+    result = rdLoc(tmp)
   else:
     initLocExpr(p, n, a)
     result = rdLoc(a)
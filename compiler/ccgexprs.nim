@@ -725,6 +725,11 @@ proc genCheckedRecordField(p: BProc, e: PNode, d: var TLoc) =
   else:
     genRecordField(p, e.sons[0], d)
 
+proc checkElided(e: PNode): bool =
+  # the index of 'e' has been proven to be in range by 'transf' or 'sempass2'
+  result = nfInBounds in e.flags
+  if result: Message(e.info, hintBoundCheckElided, renderTree(e))
+
 proc genArrayElem(p: BProc, e: PNode, d: var TLoc) =
   var a, b: TLoc
   initLocExpr(p, e.sons[0], a)
@@ -736,10 +741,11 @@ proc genArrayElem(p: BProc, e: PNode, d: var TLoc) =
     if not isConstExpr(e.sons[1]):
       # semantic pass has already checked for const index expressions
       if firstOrd(ty) == 0:
-        if (firstOrd(b.t) < firstOrd(ty)) or (lastOrd(b.t) > lastOrd(ty)):
+        if ((firstOrd(b.t) < firstOrd(ty)) or (lastOrd(b.t) > lastOrd(ty))) and
+            not checkElided(e):
           linefmt(p, cpsStmts, "if ((NU)($1) > (NU)($2)) #raiseIndexError();$n",
                   rdCharLoc(b), intLiteral(lastOrd(ty)))
-      else:
+      elif not checkElided(e):
         linefmt(p, cpsStmts, "if ($1 < $2 || $1 > $3) #raiseIndexError();$n",
                 rdCharLoc(b), first, intLiteral(lastOrd(ty)))
     else:
@@ -763,7 +769,7 @@ proc genOpenArrayElem(p: BProc, e: PNode, d: var TLoc) =
   var a, b: TLoc
   initLocExpr(p, e.sons[0], a)
   initLocExpr(p, e.sons[1], b) # emit range check:
-  if optBoundsCheck in p.options:
+  if optBoundsCheck in p.options and not checkElided(e):
     linefmt(p, cpsStmts, "if ((NU)($1) >= (NU)($2Len0)) #raiseIndexError();$n",
             rdLoc(b), rdLoc(a)) # BUGFIX: ``>=`` and not ``>``!
   if d.k == locNone: d.s = a.s
@@ -777,7 +783,7 @@ proc genSeqElem(p: BPRoc, e: PNode, d: var TLoc) =
   var ty = skipTypes(a.t, abstractVarRange)
   if ty.kind in {tyRef, tyPtr}:
     ty = skipTypes(ty.sons[0], abstractVarRange) # emit range check:
-  if optBoundsCheck in p.options:
+  if optBoundsCheck in p.options and not checkElided(e):
     if ty.kind == tyString:
       linefmt(p, cpsStmts,
            "if ((NU)($1) > (NU)($2->$3)) #raiseIndexError();$n",
@@ -973,11 +979,26 @@ proc rawGenNew(p: BProc, a: TLoc, sizeExpr: PRope) =
   let bt = skipTypes(refType.sons[0], abstractRange)
   genObjectInit(p, cpsStmts, bt, a, false)
 
+proc genStackNew(p: BProc, a: TLoc) =
+  # the escape analysis proved that the object cannot outlive the frame, so
+  # a zeroed stack slot replaces the heap allocation:
+  let bt = skipTypes(skipTypes(a.t, abstractVarRange).sons[0], abstractRange)
+  var slot: TLoc
+  getTemp(p, bt, slot)
+  linefmt(p, cpsStmts, "$1 = $2;$n", a.rdLoc, addrLoc(slot))
+
+proc isStackNew(e: PNode): bool =
+  var x = e.sons[1]
+  if x.kind == nkHiddenAddr: x = x.sons[0]
+  result = e.len == 2 and x.kind == nkSym and sfStackAlloc in x.sym.flags
+
 proc genNew(p: BProc, e: PNode) =
   var a: TLoc
   InitLocExpr(p, e.sons[1], a)
   # 'genNew' also handles 'unsafeNew':
-  if e.len == 3:
+  if isStackNew(e):
+    genStackNew(p, a)
+  elif e.len == 3:
     var se: TLoc
     InitLocExpr(p, e.sons[2], se)
     rawGenNew(p, a, se.rdLoc)
@@ -1237,9 +1258,18 @@ proc genSwap(p: BProc, e: PNode, d: var TLoc) =
   getTemp(p, skipTypes(e.sons[1].typ, abstractVar), tmp)
   InitLocExpr(p, e.sons[1], a) # eval a
   InitLocExpr(p, e.sons[2], b) # eval b
-  genAssignment(p, tmp, a, {})
-  genAssignment(p, a, b, {})
-  genAssignment(p, b, tmp, {})
+  let t = skipTypes(a.t, abstractVarRange)
+  if t.kind in {tyRef, tyString, tySequence} and a.s == b.s and
+      (a.s == OnStack or a.s == OnHeap and gSelectedGC == gcRefc):
+    # both locations are counted alike, so no reference count changes; the
+    # GCs after 'gcRefc' need the write barrier for heap locations:
+    linefmt(p, cpsStmts, "$1 = $2;$n", tmp.rdLoc, a.rdLoc)
+    linefmt(p, cpsStmts, "$1 = $2;$n", a.rdLoc, b.rdLoc)
+    linefmt(p, cpsStmts, "$1 = $2;$n", b.rdLoc, tmp.rdLoc)
+  else:
+    genAssignment(p, tmp, a, {})
+    genAssignment(p, a, b, {})
+    genAssignment(p, b, tmp, {})
 
 proc rdSetElemLoc(a: TLoc, setType: PType): PRope =
   # read a location of an set element; it may need a substraction operation
@@ -1751,6 +1781,57 @@ proc downConv(p: BProc, n: PNode, d: var TLoc) =
       for i in countup(1, abs(inheritanceDiff(dest, src))): app(r, ".Sup")
     putIntoDest(p, d, n.typ, r)
 
+proc constrFieldValue(n: PNode, field: PSym): PNode =
+  # the value the object constructor `n` gives to `field` or nil
+  for i in countup(1, sonsLen(n) - 1):
+    if n.sons[i].sons[0].sym.name.id == field.name.id: 
+      return n.sons[i].sons[1]
+
+proc hasConstFields(rec, n: PNode): bool =
+  case rec.kind
+  of nkRecList:
+    for i in countup(0, sonsLen(rec) - 1):
+      if not hasConstFields(rec.sons[i], n): return false
+    result = true
+  of nkSym:
+    # a field left out stays zero, which is wrong if it needs a type field:
+    result = analyseObjectWithTypeField(rec.sym.typ) == frNone or
+             constrFieldValue(n, rec.sym) != nil
+  else:
+    # variant parts are unions in C, which we cannot initialize portably
+    result = false
+
+proc isConstObjConstr(n: PNode): bool =
+  # whether the object constructor `n` can be emitted as a C initializer
+  var t = skipTypes(n.typ, abstractInst)
+  if t.kind != tyObject: return false
+  while t != nil:
+    if tfIncompleteStruct in t.flags or 
+        (t.sym != nil and sfImportc in t.sym.flags):
+      return false
+    if t.sons[0] != nil and gCmd == cmdCompileToCpp: return false
+    if t.n != nil and not hasConstFields(t.n, n): return false
+    t = t.sons[0]
+    if t != nil: t = skipTypes(t, abstractInst)
+  result = true
+
+proc isDeepConstData(n: PNode): bool =
+  # like ``isDeepConstExpr``, but also checks that the object constructors
+  # in `n` have a C initializer
+  case n.kind
+  of nkObjConstr:
+    if not isConstObjConstr(n): return false
+    for i in countup(1, sonsLen(n) - 1):
+      if not isDeepConstData(n.sons[i]): return false
+    result = true
+  of nkExprEqExpr, nkExprColonExpr, nkHiddenStdConv, nkHiddenSubConv:
+    result = isDeepConstData(n.sons[1])
+  of nkCurly, nkBracket, nkPar, nkClosure:
+    for i in countup(0, sonsLen(n) - 1):
+      if not isDeepConstData(n.sons[i]): return false
+    result = true
+  else: result = isDeepConstExpr(n)
+
 proc exprComplexConst(p: BProc, n: PNode, d: var TLoc) =
   var t = getUniqueType(n.typ)
   discard getTypeDesc(p.module, t) # so that any fields are initialized
@@ -1774,7 +1855,7 @@ proc expr(p: BProc, n: PNode, d: var TLoc) =
     var sym = n.sym
     case sym.Kind
     of skMethod:
-      if sym.getBody.kind == nkEmpty or sfDispatcher in sym.flags:
+      if sfDispatcher in sym.flags or sym.getBody.kind == nkEmpty:
         # we cannot produce code for the dispatcher yet:
         fillProcLoc(sym)
         genProcPrototype(p.module, sym)
@@ -1846,18 +1927,22 @@ proc expr(p: BProc, n: PNode, d: var TLoc) =
     else:
       genSetConstr(p, n, d)
   of nkBracket:
-    if isDeepConstExpr(n) and n.len != 0:
+    if isDeepConstData(n) and n.len != 0:
       exprComplexConst(p, n, d)
     elif skipTypes(n.typ, abstractVarRange).kind == tySequence:
       genSeqConstr(p, n, d)
     else:
       genArrayConstr(p, n, d)
   of nkPar:
-    if isDeepConstExpr(n) and n.len != 0:
+    if isDeepConstData(n) and n.len != 0:
       exprComplexConst(p, n, d)
     else:
       genTupleConstr(p, n, d)
-  of nkObjConstr: genObjConstr(p, n, d)
+  of nkObjConstr:
+    if isDeepConstData(n):
+      exprComplexConst(p, n, d)
+    else:
+      genObjConstr(p, n, d)
   of nkCast: genCast(p, n, d)
   of nkHiddenStdConv, nkHiddenSubConv, nkConv: genConv(p, n, d)
   of nkHiddenAddr, nkAddr: genAddr(p, n, d)
@@ -1876,8 +1961,7 @@ proc expr(p: BProc, n: PNode, d: var TLoc) =
   of nkCheckedFieldExpr: genCheckedRecordField(p, n, d)
   of nkBlockExpr, nkBlockStmt: genBlock(p, n, d)
   of nkStmtListExpr: genStmtListExpr(p, n, d)
-  of nkStmtList:
-    for i in countup(0, sonsLen(n) - 1): genStmts(p, n.sons[i])
+  of nkStmtList: genStmtList(p, n)
   of nkIfExpr, nkIfStmt: genIf(p, n, d)
   of nkObjDownConv: downConv(p, n, d)
   of nkObjUpConv: upConv(p, n, d)
@@ -1915,7 +1999,7 @@ proc expr(p: BProc, n: PNode, d: var TLoc) =
       initLocExpr(p, n.sons[0], a)
   of nkAsmStmt: genAsmStmt(p, n)
   of nkTryStmt:
-    if gCmd == cmdCompileToCpp: genTryCpp(p, n, d)
+    if zeroCostExceptions(): genTryCpp(p, n, d)
     else: genTry(p, n, d)
   of nkRaiseStmt: genRaiseStmt(p, n)
   of nkTypeSection:
@@ -1939,8 +2023,10 @@ proc expr(p: BProc, n: PNode, d: var TLoc) =
             ({sfExportc, sfCompilerProc} * prc.flags == {sfExportc}) or
             (sfExportc in prc.flags and lfExportLib in prc.loc.flags) or
             (prc.kind == skMethod): 
-          # we have not only the header: 
-          if prc.getBody.kind != nkEmpty or lfDynamicLib in prc.loc.flags: 
+          # we have not only the header; check the flags first so that
+          # imported procs never load their body from a symbol file:
+          if lfDynamicLib in prc.loc.flags or
+              sfImportc notin prc.flags and prc.getBody.kind != nkEmpty: 
             genProc(p.module, prc)
   of nkParForStmt: genParForStmt(p, n)
   of nkState: genState(p, n)
@@ -1983,6 +2069,37 @@ proc genConstSeq(p: BProc, n: PNode, t: PType): PRope =
 
   result = ropef("(($1)&$2)", [getTypeDesc(p.module, t), result])
 
+proc genConstObjFields(p: BProc, rec, n: PNode, items: var PRope) =
+  case rec.kind
+  of nkRecList:
+    for i in countup(0, sonsLen(rec) - 1): 
+      genConstObjFields(p, rec.sons[i], n, items)
+  of nkSym:
+    var field = rec.sym
+    if field.typ.kind == tyEmpty: return
+    if items != nil: appf(items, ",$n")
+    var value = constrFieldValue(n, field)
+    if value != nil: app(items, genConstExpr(p, value))
+    elif mapType(field.typ) in {ctArray, ctStruct}: app(items, "{0}")
+    else: app(items, "0")
+  else: internalError(rec.info, "genConstObjFields")
+
+proc genConstObjAux(p: BProc, t: PType, n: PNode): PRope =
+  # the fields are listed in the order of the C struct, the ancestor's part
+  # (or the type field) comes first:
+  var items: PRope = nil
+  if t.sons[0] != nil:
+    items = genConstObjAux(p, skipTypes(t.sons[0], abstractInst), n)
+  elif not isObjLackingTypeField(t):
+    # the type info is defined after the data section:
+    discard genTypeInfo(p.module, n.typ)
+    var ti = ropef("NTI$1", [toRope(getUniqueType(n.typ).id)])
+    appf(p.module.s[cfsData], "extern TNimType $1;$n", [ti])
+    items = con("&", ti)
+  if t.n != nil: genConstObjFields(p, t.n, n, items)
+  if items == nil: items = toRope("0") # for the dummy field
+  result = ropef("{$1}", [items])
+
 proc genConstExpr(p: BProc, n: PNode): PRope =
   case n.Kind
   of nkHiddenStdConv, nkHiddenSubConv:
@@ -1997,6 +2114,8 @@ proc genConstExpr(p: BProc, n: PNode): PRope =
       result = genConstSeq(p, n, t)
     else:
       result = genConstSimpleList(p, n)
+  of nkObjConstr:
+    result = genConstObjAux(p, skipTypes(n.typ, abstractInst), n)
   else:
     var d: TLoc
     initLocExpr(p, n, d)
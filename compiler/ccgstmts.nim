@@ -13,7 +13,15 @@ const
   RangeExpandLimit = 256      # do not generate ranges
                               # over 'RangeExpandLimit' elements
   stringCaseThreshold = 8
-    # above X strings a hash-switch for strings is generated
+    # above X strings a switch over the length and a few characters
+    # is generated
+  stringCaseMaxReads = 4
+    # if more characters need to be inspected, a hash-switch is generated
+  bitTestMaxBranches = 3      # ordinal cases over at most 64 values with
+                              # so many branches use bit mask tests
+  jumpTableMinDensity = 0.4   # sparser cases use a binary search tree ...
+  jumpTableMaxSpan = 4096     # ... and so do cases over bigger domains
+  binaryTreeLeafSize = 3      # number of ranges that are tested linearly
 
 proc registerGcRoot(p: BProc, v: PSym) =
   if gSelectedGc in {gcMarkAndSweep, gcGenerational} and
@@ -54,6 +62,11 @@ proc loadInto(p: BProc, le, ri: PNode, a: var TLoc) {.inline.} =
   if ri.kind in nkCallKinds and (ri.sons[0].kind != nkSym or
                                  ri.sons[0].sym.magic == mNone):
     genAsgnCall(p, le, ri, a)
+  elif nfMove in ri.flags:
+    # last read of the source, so its buffer can be stolen:
+    var dest = a
+    incl(dest.flags, lfNoDeepCopy)
+    expr(p, ri, dest)
   else:
     expr(p, ri, a)
 
@@ -271,7 +284,7 @@ proc blockLeaveActions(p: BProc, howMany: int) =
   
   var alreadyPoppedCnt = p.inExceptBlock
   for tryStmt in items(stack):
-    if gCmd != cmdCompileToCpp:
+    if not zeroCostExceptions():
       if alreadyPoppedCnt > 0:
         dec alreadyPoppedCnt
       else:
@@ -282,9 +295,8 @@ proc blockLeaveActions(p: BProc, howMany: int) =
   # push old elements again:
   for i in countdown(howMany-1, 0): 
     p.nestedTryStmts.add(stack[i])
-  if gCmd != cmdCompileToCpp:
-    for i in countdown(p.inExceptBlock-1, 0):
-      linefmt(p, cpsStmts, "#popCurrentException();$n")
+  for i in countdown(p.inExceptBlock-1, 0):
+    linefmt(p, cpsStmts, "#popCurrentException();$n")
 
 proc genReturnStmt(p: BProc, t: PNode) =
   p.beforeRetNeeded = true
@@ -440,10 +452,9 @@ proc genBreakStmt(p: BProc, t: PNode) =
   lineF(p, cpsStmts, "goto $1;$n", [label])
 
 proc getRaiseFrmt(p: BProc): string = 
-  if gCmd == cmdCompileToCpp: 
-    result = "throw NimException($1, $2);$n"
-  else:
-    result = "#raiseException((#E_Base*)$1, $2);$n"
+  # with zero cost exceptions 'raiseException' throws the C++ exception;
+  # it still runs the raise hooks and records the stack trace:
+  result = "#raiseException((#E_Base*)$1, $2);$n"
 
 proc genRaiseStmt(p: BProc, t: PNode) =
   if p.inExceptBlock > 0:
@@ -462,10 +473,7 @@ proc genRaiseStmt(p: BProc, t: PNode) =
   else: 
     genLineDir(p, t)
     # reraise the last exception:
-    if gCmd == cmdCompileToCpp:
-      line(p, cpsStmts, ~"throw;$n")
-    else:
-      linefmt(p, cpsStmts, "#reraiseException();$n")
+    linefmt(p, cpsStmts, "#reraiseException();$n")
 
 proc genCaseGenericBranch(p: BProc, b: PNode, e: TLoc, 
                           rangeFormat, eqFormat: TFormatStr, labl: TLabel) = 
@@ -535,33 +543,122 @@ proc genCaseStringBranch(p: BProc, b: PNode, e: TLoc, labl: TLabel,
     appcg(p.module, branches[j], "if (#eqStrings($1, $2)) goto $3;$n", 
          [rdLoc(e), rdLoc(x), labl])
 
+type
+  TStrCaseEntry = tuple[s: string, labl: TLabel]
+
+proc bestDiscriminator(entries: openArray[TStrCaseEntry]): int =
+  # returns the position of the character that splits the (equally long)
+  # strings into the most groups
+  var best = 0
+  result = -1
+  for pos in countup(0, len(entries[0].s) - 1):
+    var seen: set[char] = {}
+    var groups = 0
+    for e in items(entries):
+      if e.s[pos] notin seen:
+        incl(seen, e.s[pos])
+        inc(groups)
+    if groups > best:
+      best = groups
+      result = pos
+
+proc charReads(entries: seq[TStrCaseEntry]): int =
+  # the number of characters the decision tree has to read in the worst
+  # case before the final comparison
+  if len(entries) <= 1: return 0
+  var pos = bestDiscriminator(entries)
+  var groups: array[char, seq[TStrCaseEntry]]
+  for e in items(entries):
+    if isNil(groups[e.s[pos]]): groups[e.s[pos]] = @[]
+    groups[e.s[pos]].add(e)
+  for c in low(char)..high(char):
+    if not isNil(groups[c]): result = max(result, charReads(groups[c]))
+  inc(result)
+
+proc genStringCaseTree(p: BProc, entries: seq[TStrCaseEntry], e: PRope) =
+  # all entries have the same length; switch on the character that
+  # discriminates best until a single candidate is left, then verify it
+  # with a single ``memcmp``:
+  if len(entries) == 1:
+    let L = len(entries[0].s)
+    if L == 0:
+      lineF(p, cpsStmts, "goto $1;$n", [entries[0].labl])
+    else:
+      lineF(p, cpsStmts, "if (memcmp($1->data, $2, $3) == 0) goto $4;$n",
+           [e, makeCString(entries[0].s), toRope(L), entries[0].labl])
+    return
+  var pos = bestDiscriminator(entries)
+  var groups: array[char, seq[TStrCaseEntry]]
+  for x in items(entries):
+    if isNil(groups[x.s[pos]]): groups[x.s[pos]] = @[]
+    groups[x.s[pos]].add(x)
+  lineF(p, cpsStmts, "switch ((NU8)$1->data[$2]) {$n", [e, toRope(pos)])
+  for c in low(char)..high(char):
+    if not isNil(groups[c]):
+      lineF(p, cpsStmts, "case $1:$n", [toRope(ord(c))])
+      genStringCaseTree(p, groups[c], e)
+      lineF(p, cpsStmts, "break;$n")
+  lineF(p, cpsStmts, "}$n")
+
+proc genStringCaseByLen(p: BProc, a: TLoc, byLen: seq[seq[TStrCaseEntry]]) =
+  # a nil string matches no branch; the case statement has an 'else'
+  # section, so this falls through to it:
+  lineF(p, cpsStmts, "if ($1) switch ($1->Sup.len) {$n", [rdLoc(a)])
+  for L in countup(0, high(byLen)):
+    if not isNil(byLen[L]):
+      lineF(p, cpsStmts, "case $1:$n", [toRope(L)])
+      genStringCaseTree(p, byLen[L], rdLoc(a))
+      lineF(p, cpsStmts, "break;$n")
+  lineF(p, cpsStmts, "}$n")
+
 proc genStringCase(p: BProc, t: PNode, d: var TLoc) =
   # count how many constant strings there are in the case:
   var strings = 0
   for i in countup(1, sonsLen(t) - 1):
     if t.sons[i].kind == nkOfBranch: inc(strings, sonsLen(t.sons[i]) - 1)
   if strings > stringCaseThreshold:
-    var bitMask = math.nextPowerOfTwo(strings) - 1
-    var branches: seq[PRope]
-    newSeq(branches, bitMask + 1)
     var a: TLoc
     initLocExpr(p, t.sons[0], a) # fist pass: gnerate ifs+goto:
     var labId = p.labels
-    for i in countup(1, sonsLen(t) - 1): 
-      inc(p.labels)
-      if t.sons[i].kind == nkOfBranch: 
-        genCaseStringBranch(p, t.sons[i], a, con("LA", toRope(p.labels)), 
-                            branches)
-      else: 
-        # else statement: nothing to do yet
-        # but we reserved a label, which we use later
-    linefmt(p, cpsStmts, "switch (#hashString($1) & $2) {$n", 
-            rdLoc(a), toRope(bitMask))
-    for j in countup(0, high(branches)):
-      if branches[j] != nil:
-        lineF(p, cpsStmts, "case $1: $n$2break;$n", 
-             [intLiteral(j), branches[j]])
-    lineF(p, cpsStmts, "}$n") # else statement:
+    # bucket the strings by length; within a bucket a few characters
+    # suffice to select the only candidate:
+    var byLen: seq[seq[TStrCaseEntry]] = @[]
+    for i in countup(1, sonsLen(t) - 1):
+      let b = t.sons[i]
+      if b.kind == nkOfBranch:
+        for j in countup(0, sonsLen(b) - 2):
+          assert(b.sons[j].kind in {nkStrLit..nkTripleStrLit})
+          let s = b.sons[j].strVal
+          if len(byLen) <= len(s): setLen(byLen, len(s) + 1)
+          if isNil(byLen[len(s)]): byLen[len(s)] = @[]
+          byLen[len(s)].add((s, con("LA", toRope(labId + i))))
+    var reads = 0
+    for L in countup(0, high(byLen)):
+      if not isNil(byLen[L]): reads = max(reads, charReads(byLen[L]))
+    if reads <= stringCaseMaxReads:
+      inc(p.labels, sonsLen(t) - 1)
+      genStringCaseByLen(p, a, byLen)
+    else:
+      # the strings are too similar; hashing them is cheaper:
+      var bitMask = math.nextPowerOfTwo(strings) - 1
+      var branches: seq[PRope]
+      newSeq(branches, bitMask + 1)
+      for i in countup(1, sonsLen(t) - 1): 
+        inc(p.labels)
+        if t.sons[i].kind == nkOfBranch: 
+          genCaseStringBranch(p, t.sons[i], a, con("LA", toRope(p.labels)), 
+                              branches)
+        else: 
+          # else statement: nothing to do yet
+          # but we reserved a label, which we use later
+      linefmt(p, cpsStmts, "switch (#hashString($1) & $2) {$n", 
+              rdLoc(a), toRope(bitMask))
+      for j in countup(0, high(branches)):
+        if branches[j] != nil:
+          lineF(p, cpsStmts, "case $1: $n$2break;$n", 
+               [intLiteral(j), branches[j]])
+      lineF(p, cpsStmts, "}$n")
+    # else statement:
     if t.sons[sonsLen(t)-1].kind != nkOfBranch: 
       lineF(p, cpsStmts, "goto LA$1;$n", [toRope(p.labels)]) 
     # third pass: generate statements
@@ -603,7 +700,120 @@ proc genCaseRange(p: BProc, branch: PNode) =
     else:
       lineF(p, cpsStmts, "case $1:$n", [genLiteral(p, branch[j])])
 
+type
+  TCaseStrategy = enum
+    csSwitch,                 # a C switch; the C compiler builds a jump table
+    csBitTest,                # a bit mask test per branch
+    csBinaryTree              # a balanced binary search over sorted ranges
+  TCaseRange = tuple[a, b: biggestInt, branch: int]
+
+proc caseRanges(n: PNode): seq[TCaseRange] =
+  # collects the ranges of all branches sorted by their lower bound;
+  # 'sem' already ensured that they do not overlap
+  result = @[]
+  for i in countup(1, sonsLen(n) - 1):
+    var branch = n.sons[i]
+    if branch.kind != nkOfBranch: continue
+    for j in countup(0, sonsLen(branch) - 2):
+      if branch.sons[j].kind == nkRange:
+        result.add((getOrdValue(branch.sons[j].sons[0]),
+                    getOrdValue(branch.sons[j].sons[1]), i))
+      else:
+        let v = getOrdValue(branch.sons[j])
+        result.add((v, v, i))
+  # insertion sort; case statements are small:
+  for i in countup(1, high(result)):
+    var x = result[i]
+    var j = i - 1
+    while j >= 0 and result[j].a > x.a:
+      result[j+1] = result[j]
+      dec(j)
+    result[j+1] = x
+
+proc chooseCaseStrategy(n: PNode, r: seq[TCaseRange]): TCaseStrategy =
+  result = csSwitch
+  if len(r) == 0: return
+  # 'linearScanEnd' is an explicit request for the if/switch split:
+  for i in countup(1, sonsLen(n) - 1):
+    if lastSon(n.sons[i]).stmtsContainPragma(wLinearScanEnd): return
+  if skipTypes(n.sons[0].typ, abstractVarRange).kind in {tyUInt, tyUInt64}:
+    return
+  var branches = 0
+  for i in countup(1, sonsLen(n) - 1):
+    if n.sons[i].kind == nkOfBranch: inc(branches)
+  var values = 0.0
+  for x in items(r): values = values + float(x.b) - float(x.a) + 1.0
+  var span = float(r[high(r)].b) - float(r[0].a) + 1.0
+  if span <= 64.0 and branches <= bitTestMaxBranches:
+    result = csBitTest
+  elif span <= float(jumpTableMaxSpan) and
+      values / span >= jumpTableMinDensity:
+    result = csSwitch
+  elif len(r) > binaryTreeLeafSize:
+    result = csBinaryTree
+  if hintCaseStats in gNotes:
+    Message(n.info, hintCaseStats, "$1 branches, $2 ranges, density $3: $4" %
+            [$branches, $len(r), formatFloat(values / span, ffDecimal, 2),
+             ["switch", "bit test", "binary search tree"][ord(result)]])
+
+proc genCaseBinaryTree(p: BProc, r: seq[TCaseRange], lo, hi: int, e: PRope,
+                       labId: int, fallback: TLabel) =
+  if hi - lo < binaryTreeLeafSize:
+    for i in countup(lo, hi):
+      if r[i].a == r[i].b:
+        lineF(p, cpsStmts, "if ($1 == $2) goto LA$3;$n",
+              [e, intLiteral(r[i].a), toRope(labId + r[i].branch)])
+      else:
+        lineF(p, cpsStmts, "if ($1 >= $2 && $1 <= $3) goto LA$4;$n",
+              [e, intLiteral(r[i].a), intLiteral(r[i].b),
+               toRope(labId + r[i].branch)])
+    lineF(p, cpsStmts, "goto $1;$n", [fallback])
+  else:
+    var mid = (lo + hi + 1) div 2
+    lineF(p, cpsStmts, "if ($1 < $2) {$n", [e, intLiteral(r[mid].a)])
+    genCaseBinaryTree(p, r, lo, mid - 1, e, labId, fallback)
+    lineF(p, cpsStmts, "}$n")
+    genCaseBinaryTree(p, r, mid, hi, e, labId, fallback)
+
+proc genCaseBitTest(p: BProc, n: PNode, r: seq[TCaseRange], e: PRope,
+                    labId: int, fallback: TLabel) =
+  var lo = r[0].a
+  var span = r[high(r)].b - lo
+  for i in countup(1, sonsLen(n) - 1):
+    if n.sons[i].kind != nkOfBranch: continue
+    var mask: biggestInt = 0
+    for x in items(r):
+      if x.branch == i:
+        for v in countup(x.a - lo, x.b - lo): mask = mask or (1'i64 shl v)
+    lineF(p, cpsStmts, "if ((NU64)((NI64)($1) - $2) <= $3 && " &
+          "(((NU64)IL64(0x$4) >> ((NI64)($1) - $2)) & 1)) goto LA$5;$n",
+          [e, intLiteral(lo), intLiteral(span), toRope(toHex(mask, 16)),
+           toRope(labId + i)])
+  lineF(p, cpsStmts, "goto $1;$n", [fallback])
+
+proc genLoweredCase(p: BProc, n: PNode, d: var TLoc, r: seq[TCaseRange],
+                    strategy: TCaseStrategy) =
+  var a: TLoc
+  initLocExpr(p, n.sons[0], a)
+  var labId = p.labels
+  inc(p.labels, sonsLen(n) - 1)
+  # the 'else' branch; an exhaustive case statement never gets there and
+  # simply uses the last branch:
+  var fallback = con("LA", toRope(labId + sonsLen(n) - 1))
+  case strategy
+  of csBitTest: genCaseBitTest(p, n, r, rdCharLoc(a), labId, fallback)
+  of csBinaryTree:
+    genCaseBinaryTree(p, r, 0, high(r), rdCharLoc(a), labId, fallback)
+  of csSwitch: InternalError(n.info, "genLoweredCase")
+  var Lend = genCaseSecondPass(p, n, d, labId, sonsLen(n) - 1)
+  fixLabel(p, Lend)
+
 proc genOrdinalCase(p: BProc, n: PNode, d: var TLoc) =
+  var ranges = caseRanges(n)
+  var strategy = chooseCaseStrategy(n, ranges)
+  if strategy != csSwitch:
+    genLoweredCase(p, n, d, ranges, strategy)
+    return
   # analyse 'case' statement:
   var splitPoint = IfSwitchSplitPoint(p, n)
   
@@ -669,15 +879,19 @@ proc genTryCpp(p: BProc, t: PNode, d: var TLoc) =
   #   } catch (NimException& exp) {
   #      if (isObj(exp, EIO) {
   #        ...
+  #        popCurrentException();
   #      } else if (isObj(exp, ESystem) {
   #        ...
-  #        finallyPart()
-  #        raise;
+  #        popCurrentException();
   #      } else {
-  #        // general handler
+  #        finallyPart()
+  #        throw;
   #      }
   #  }
   #  finallyPart();
+  #
+  # Entering the 'try' costs nothing; 'raiseException' pushes the current
+  # exception before it throws.
   if not isEmptyType(t.typ) and d.k == locNone:
     getTemp(p, t.typ, d)
   var
@@ -702,7 +916,10 @@ proc genTryCpp(p: BProc, t: PNode, d: var TLoc) =
     if blen == 1:
       # general except section:
       catchAllPresent = true
-      exprBlock(p, t.sons[i].sons[0], d)
+      startBlock(p)
+      expr(p, t.sons[i].sons[0], d)
+      linefmt(p, cpsStmts, "#popCurrentException();$n")
+      endBlock(p)
     else:
       var orExpr: PRope = nil
       for j in countup(0, blen - 2):
@@ -711,8 +928,10 @@ proc genTryCpp(p: BProc, t: PNode, d: var TLoc) =
         appcg(p.module, orExpr,
               "#isObj($1.exp->m_type, $2)",
               [exc, genTypeInfo(p.module, t.sons[i].sons[j].typ)])
-      lineF(p, cpsStmts, "if ($1) ", [orExpr])
-      exprBlock(p, t.sons[i].sons[blen-1], d)
+      startBlock(p, "if ($1) {$n", [orExpr])
+      expr(p, t.sons[i].sons[blen-1], d)
+      linefmt(p, cpsStmts, "#popCurrentException();$n")
+      endBlock(p)
     inc(i)
   
   # reraise the exception if there was no catch all
@@ -954,6 +1173,91 @@ proc genAsgn(p: BProc, e: PNode, fastAsgn: bool) =
   else:
     asgnFieldDiscriminant(p, e)
 
+proc isMovablePath(n: PNode): bool =
+  # a location expression without side effects; the index of an array
+  # access has to be a literal or a local so that it can be evaluated twice
+  case n.kind
+  of nkSym: result = n.sym.kind in {skVar, skLet, skParam, skResult, skTemp,
+                                    skForVar}
+  of nkDotExpr, nkCheckedFieldExpr, nkHiddenDeref, nkDerefExpr:
+    result = isMovablePath(n.sons[0])
+  of nkBracketExpr:
+    let i = n.sons[1]
+    result = isMovablePath(n.sons[0]) and
+      (i.kind in {nkCharLit..nkUInt64Lit} or
+       i.kind == nkSym and i.sym.kind != skConst and sfGlobal notin i.sym.flags)
+  else: result = false
+
+proc samePath(a, b: PNode): bool =
+  if a.kind != b.kind: return false
+  case a.kind
+  of nkSym: result = a.sym.id == b.sym.id
+  of nkCharLit..nkUInt64Lit: result = a.intVal == b.intVal
+  of nkFloatLit..nkNilLit: result = false
+  else:
+    if sonsLen(a) != sonsLen(b): return false
+    for i in countup(0, sonsLen(a) - 1):
+      if not samePath(a.sons[i], b.sons[i]): return false
+    result = true
+
+proc storeCanChangePath(dest: PType, n: PNode): bool =
+  # can a store to a location of type 'dest' make the path 'n' denote a
+  # different location? Only if the path reads such a location from the heap.
+  case n.kind
+  of nkHiddenDeref, nkDerefExpr:
+    let x = n.sons[0]
+    if x.kind != nkSym or sfGlobal in x.sym.flags:
+      if sameType(skipTypes(x.typ, abstractInst), dest): return true
+    result = storeCanChangePath(dest, x)
+  of nkDotExpr, nkCheckedFieldExpr, nkBracketExpr:
+    result = storeCanChangePath(dest, n.sons[0])
+  else: result = false
+
+proc isRefMove(a, b: PNode): bool =
+  # detects the 'x = y; y = nil' idiom: the object of 'y' moves to 'x' and
+  # its reference count does not change.
+  if a.kind notin {nkAsgn, nkFastAsgn} or b.kind notin {nkAsgn, nkFastAsgn}:
+    return false
+  let dest = a.sons[0]
+  let src = a.sons[1]
+  if b.sons[1].kind != nkNilLit or not samePath(b.sons[0], src): return false
+  let t = skipTypes(dest.typ, abstractInst)
+  result = t.kind == tyRef and isMovablePath(dest) and isMovablePath(src) and
+    not storeCanChangePath(t, src)
+
+proc genRefMove(p: BProc, a, b: PNode) =
+  genLineDir(p, a)
+  var dest, src: TLoc
+  InitLocExpr(p, a.sons[0], dest)
+  InitLocExpr(p, a.sons[1], src)
+  if dest.s == OnHeap and src.s == OnHeap and gSelectedGC == gcRefc:
+    # only the old value of 'dest' loses a reference; the other native GCs
+    # need the write barrier of 'asgnRef':
+    if canFormAcycle(dest.t):
+      linefmt(p, cpsStmts, "if ($1) #nimGCunref($1);$n", dest.rdLoc)
+    else:
+      linefmt(p, cpsStmts, "if ($1) #nimGCunrefNoCycle($1);$n", dest.rdLoc)
+    linefmt(p, cpsStmts, "$1 = $2;$n", dest.rdLoc, src.rdLoc)
+    genLineDir(p, b)
+    linefmt(p, cpsStmts, "$1 = NIM_NIL;$n", src.rdLoc)
+  else:
+    genAssignment(p, dest, src, {})
+    genLineDir(p, b)
+    var nilLoc: TLoc
+    initLoc(nilLoc, locExpr, src.t, OnUnknown)
+    nilLoc.r = toRope("NIM_NIL")
+    genAssignment(p, src, nilLoc, {})
+
+proc genStmtList(p: BProc, n: PNode) =
+  var i = 0
+  while i < sonsLen(n):
+    if i < sonsLen(n) - 1 and isRefMove(n.sons[i], n.sons[i+1]):
+      genRefMove(p, n.sons[i], n.sons[i+1])
+      inc(i, 2)
+    else:
+      genStmts(p, n.sons[i])
+      inc(i)
+
 proc genStmts(p: BProc, t: PNode) = 
   var a: TLoc
   expr(p, t, a)
@@ -680,28 +680,21 @@ proc genProcHeader(m: BModule, prc: PSym): PRope =
     result = ropef(prc.cgDeclFrmt, [rettype, prc.loc.r, params])
 
 # ------------------ type info generation -------------------------------------
+# The type information is emitted as statically initialized data, so no code
+# has to run at startup to build it; only the marker and finalizer procs are
+# still patched in by the init code. The parts of a type info are generated
+# before the type info itself, which is why every TNimType is declared first.
 
 proc genTypeInfo(m: BModule, t: PType): PRope
-proc getNimNode(m: BModule): PRope = 
-  result = ropef("$1[$2]", [m.typeNodesName, toRope(m.typeNodes)])
-  inc(m.typeNodes)
-
-when false:
-  proc getNimType(m: BModule): PRope = 
-    result = ropef("$1[$2]", [m.nimTypesName, toRope(m.nimTypes)])
-    inc(m.nimTypes)
-
-  proc allocMemTI(m: BModule, typ: PType, name: PRope) = 
-    var tmp = getNimType(m)
-    appf(m.s[cfsTypeInit2], "$2 = &$1;$n", [tmp, name])
 
 proc isObjLackingTypeField(typ: PType): bool {.inline.} =
   result = (typ.kind == tyObject) and ((tfFinal in typ.flags) and
       (typ.sons[0] == nil) or isPureObject(typ))
 
-proc genTypeInfoAuxBase(m: BModule, typ: PType, name, base: PRope) =
+proc genTypeInfoAuxBase(m: BModule, typ: PType, name, base: PRope,
+                        node: PRope = nil, flags = 0, depth = 0,
+                        display: PRope = nil) =
   var nimtypeKind: int
-  #allocMemTI(m, typ, name)
   if isObjLackingTypeField(typ):
     nimtypeKind = ord(tyPureObject)
   else:
@@ -710,27 +703,50 @@ proc genTypeInfoAuxBase(m: BModule, typ: PType, name, base: PRope) =
   var size: PRope
   if tfIncompleteStruct in typ.flags: size = toRope"void*"
   else: size = getTypeDesc(m, typ)
-  appf(m.s[cfsTypeInit3], 
-       "$1.size = sizeof($2);$n" & "$1.kind = $3;$n" & "$1.base = $4;$n", 
-       [name, size, toRope(nimtypeKind), base])
   # compute type flags for GC optimization
-  var flags = 0
+  var flags = flags
   if not containsGarbageCollectedRef(typ): flags = flags or 1
   if not canFormAcycle(typ): flags = flags or 2        
   #else MessageOut("can contain a cycle: " & typeToString(typ))
-  if flags != 0: 
-    appf(m.s[cfsTypeInit3], "$1.flags = $2;$n", [name, toRope(flags)])
+  var nodeRef = toRope"0"
+  if node != nil: nodeRef = con("&".toRope, node)
+  var displayRef = toRope"0"
+  if display != nil: displayRef = ropef("&$1[0]", [display])
   discard cgsym(m, "TNimType")
-  appf(m.s[cfsVars], "TNimType $1; /* $2 */$n", 
-       [name, toRope(typeToString(typ))])
+  # size, kind, flags, base, node, finalizer, marker, depth, display:
+  appf(m.s[cfsVars], "TNimType $1 = {sizeof($2), $3, $4, $5, $6, 0, 0, $7, $8};" &
+       " /* $9 */$n", [name, size, toRope(nimtypeKind), toRope(flags), base,
+       nodeRef, toRope(depth), displayRef, toRope(typeToString(typ))])
 
-proc genTypeInfoAux(m: BModule, typ: PType, name: PRope) = 
+proc genTypeInfoAux(m: BModule, typ: PType, name: PRope, node: PRope = nil,
+                    flags = 0) = 
   var base: PRope
   if (sonsLen(typ) > 0) and (typ.sons[0] != nil): 
     base = genTypeInfo(m, typ.sons[0])
   else: 
     base = toRope("0")
-  genTypeInfoAuxBase(m, typ, name, base)
+  genTypeInfoAuxBase(m, typ, name, base, node, flags)
+
+proc genNimNode(m: BModule, kind: int, offset, typ, name: PRope,
+                len: biggestInt, sons: PRope): PRope =
+  # emits a static TNimNode; `sons` is the name of an array of node pointers
+  result = getTempName()
+  var sonsRef = toRope"0"
+  if sons != nil: sonsRef = ropef("&$1[0]", [sons])
+  discard cgsym(m, "TNimNode")
+  appf(m.s[cfsVars], "static TNimNode $1 = {$2, $3, $4, $5, $6, $7};$n",
+       [result, toRope(kind), offset, typ, name, toRope(len), sonsRef])
+
+proc genNodeList(m: BModule, nodes: openArray[PRope]): PRope =
+  # emits the array of pointers to `nodes` that a list node refers to
+  if len(nodes) == 0: return nil
+  result = getTempName()
+  var items: PRope = nil
+  for i in countup(0, high(nodes)):
+    if i > 0: app(items, ", ")
+    appf(items, "&$1", [nodes[i]])
+  appf(m.s[cfsVars], "static TNimNode* $1[$2] = {$3};$n",
+       [result, toRope(len(nodes)), items])
 
 proc discriminatorTableName(m: BModule, objtype: PType, d: PSym): PRope = 
   # bugfix: we need to search the type that contains the discriminator:
@@ -747,41 +763,31 @@ proc discriminatorTableDecl(m: BModule, objtype: PType, d: PSym): PRope =
   var tmp = discriminatorTableName(m, objtype, d)
   result = ropef("TNimNode* $1[$2];$n", [tmp, toRope(lengthOrd(d.typ)+1)])
 
-proc genObjectFields(m: BModule, typ: PType, n: PNode, expr: PRope) = 
+proc genObjectFields(m: BModule, typ: PType, n: PNode): PRope = 
+  # returns the name of the node that describes `n`
   case n.kind
   of nkRecList: 
     var L = sonsLen(n)
     if L == 1: 
-      genObjectFields(m, typ, n.sons[0], expr)
-    elif L > 0: 
-      var tmp = getTempName()
-      appf(m.s[cfsTypeInit1], "static TNimNode* $1[$2];$n", [tmp, toRope(L)])
-      for i in countup(0, L-1): 
-        var tmp2 = getNimNode(m)
-        appf(m.s[cfsTypeInit3], "$1[$2] = &$3;$n", [tmp, toRope(i), tmp2])
-        genObjectFields(m, typ, n.sons[i], tmp2)
-      appf(m.s[cfsTypeInit3], "$1.len = $2; $1.kind = 2; $1.sons = &$3[0];$n", 
-           [expr, toRope(L), tmp])
+      result = genObjectFields(m, typ, n.sons[0])
     else:
-      appf(m.s[cfsTypeInit3], "$1.len = $2; $1.kind = 2;$n", [expr, toRope(L)])
+      var sons: seq[PRope] = @[]
+      for i in countup(0, L-1): sons.add(genObjectFields(m, typ, n.sons[i]))
+      result = genNimNode(m, 2, toRope"0", toRope"0", toRope"0", L,
+                          genNodeList(m, sons))
   of nkRecCase: 
     assert(n.sons[0].kind == nkSym)
     var field = n.sons[0].sym
     var tmp = discriminatorTableName(m, typ, field)
     var L = lengthOrd(field.typ)
     assert L > 0
-    appf(m.s[cfsTypeInit3], "$1.kind = 3;$n" &
-        "$1.offset = offsetof($2, $3);$n" & "$1.typ = $4;$n" &
-        "$1.name = $5;$n" & "$1.sons = &$6[0];$n" &
-        "$1.len = $7;$n", [expr, getTypeDesc(m, typ), field.loc.r, 
-                           genTypeInfo(m, field.typ), 
-                           makeCString(field.name.s), 
-                           tmp, toRope(L)])
-    appf(m.s[cfsData], "TNimNode* $1[$2];$n", [tmp, toRope(L+1)])
+    # the table maps every value of the discriminator to its branch; the
+    # last entry is the 'else' branch:
+    var branches: seq[PRope]
+    newSeq(branches, int(L)+1)
     for i in countup(1, sonsLen(n)-1): 
       var b = n.sons[i]           # branch
-      var tmp2 = getNimNode(m)
-      genObjectFields(m, typ, lastSon(b), tmp2)
+      var node = genObjectFields(m, typ, lastSon(b))
       case b.kind
       of nkOfBranch: 
         if sonsLen(b) < 2: 
@@ -791,102 +797,113 @@ proc genObjectFields(m: BModule, typ: PType, n: PNode, expr: PRope) =
             var x = int(getOrdValue(b.sons[j].sons[0]))
             var y = int(getOrdValue(b.sons[j].sons[1]))
             while x <= y: 
-              appf(m.s[cfsTypeInit3], "$1[$2] = &$3;$n", [tmp, toRope(x), tmp2])
+              branches[x] = node
               inc(x)
           else: 
-            appf(m.s[cfsTypeInit3], "$1[$2] = &$3;$n", 
-                 [tmp, toRope(getOrdValue(b.sons[j])), tmp2])
+            branches[int(getOrdValue(b.sons[j]))] = node
       of nkElse: 
-        appf(m.s[cfsTypeInit3], "$1[$2] = &$3;$n", 
-             [tmp, toRope(L), tmp2])
+        branches[int(L)] = node
       else: internalError(n.info, "genObjectFields(nkRecCase)")
+    var items: PRope = nil
+    for i in countup(0, int(L)):
+      if i > 0: app(items, ", ")
+      if branches[i] == nil: app(items, "0")
+      else: appf(items, "&$1", [branches[i]])
+    appf(m.s[cfsVars], "TNimNode* $1[$2] = {$3};$n", 
+         [tmp, toRope(L+1), items])
+    result = genNimNode(m, 3, ropef("offsetof($1, $2)", 
+                        [getTypeDesc(m, typ), field.loc.r]),
+                        genTypeInfo(m, field.typ), makeCString(field.name.s),
+                        L, tmp)
   of nkSym: 
     var field = n.sym
-    appf(m.s[cfsTypeInit3], "$1.kind = 1;$n" &
-        "$1.offset = offsetof($2, $3);$n" & "$1.typ = $4;$n" &
-        "$1.name = $5;$n", [expr, getTypeDesc(m, typ), 
-        field.loc.r, genTypeInfo(m, field.typ), makeCString(field.name.s)])
+    result = genNimNode(m, 1, ropef("offsetof($1, $2)", 
+                        [getTypeDesc(m, typ), field.loc.r]),
+                        genTypeInfo(m, field.typ), makeCString(field.name.s),
+                        0, nil)
   else: internalError(n.info, "genObjectFields")
   
+proc genObjectDisplay(m: BModule, typ: PType, depth: var int): PRope =
+  # the display lists the ancestors of `typ`, root first and ending with
+  # `typ` itself, so that ``isObj`` is a single compare:
+  var ancestors: seq[PRope] = @[]
+  var t = typ
+  while t != nil:
+    ancestors.add(genTypeInfo(m, t))
+    t = t.sons[0]
+    if t != nil: t = skipTypes(t, skipPtrs)
+  result = getTempName()
+  var L = len(ancestors)
+  var items: PRope = nil
+  for i in countup(0, L-1):
+    if i > 0: app(items, ", ")
+    app(items, ancestors[L-1-i])
+  appf(m.s[cfsVars], "static TNimType* $1[$2] = {$3};$n", 
+       [result, toRope(L), items])
+  depth = L-1
+
 proc genObjectInfo(m: BModule, typ: PType, name: PRope) = 
-  if typ.kind == tyObject: genTypeInfoAux(m, typ, name)
-  else: genTypeInfoAuxBase(m, typ, name, toRope("0"))
-  var tmp = getNimNode(m)
-  genObjectFields(m, typ, typ.n, tmp)
-  appf(m.s[cfsTypeInit3], "$1.node = &$2;$n", [name, tmp])
+  var node = genObjectFields(m, typ, typ.n)
+  if typ.kind == tyObject:
+    var base = toRope("0")
+    if (sonsLen(typ) > 0) and (typ.sons[0] != nil): 
+      base = genTypeInfo(m, typ.sons[0])
+    var depth = 0
+    var display: PRope = nil
+    if not isObjLackingTypeField(typ): display = genObjectDisplay(m, typ, depth)
+    genTypeInfoAuxBase(m, typ, name, base, node, 0, depth, display)
+  else: genTypeInfoAuxBase(m, typ, name, toRope("0"), node)
 
 proc genTupleInfo(m: BModule, typ: PType, name: PRope) =
-  genTypeInfoAuxBase(m, typ, name, toRope("0"))
-  var expr = getNimNode(m)
   var length = sonsLen(typ)
-  if length > 0: 
-    var tmp = getTempName()
-    appf(m.s[cfsTypeInit1], "static TNimNode* $1[$2];$n", [tmp, toRope(length)])
-    for i in countup(0, length - 1): 
-      var a = typ.sons[i]
-      var tmp2 = getNimNode(m)
-      appf(m.s[cfsTypeInit3], "$1[$2] = &$3;$n", [tmp, toRope(i), tmp2])
-      appf(m.s[cfsTypeInit3], "$1.kind = 1;$n" &
-          "$1.offset = offsetof($2, Field$3);$n" & 
-          "$1.typ = $4;$n" &
-          "$1.name = \"Field$3\";$n", 
-           [tmp2, getTypeDesc(m, typ), toRope(i), genTypeInfo(m, a)])
-    appf(m.s[cfsTypeInit3], "$1.len = $2; $1.kind = 2; $1.sons = &$3[0];$n", 
-         [expr, toRope(length), tmp])
-  else: 
-    appf(m.s[cfsTypeInit3], "$1.len = $2; $1.kind = 2;$n", 
-         [expr, toRope(length)])
-  appf(m.s[cfsTypeInit3], "$1.node = &$2;$n", [name, expr])
+  var sons: seq[PRope] = @[]
+  for i in countup(0, length - 1): 
+    sons.add(genNimNode(m, 1, ropef("offsetof($1, Field$2)", 
+                        [getTypeDesc(m, typ), toRope(i)]),
+                        genTypeInfo(m, typ.sons[i]),
+                        ropef("\"Field$1\"", [toRope(i)]), 0, nil))
+  var node = genNimNode(m, 2, toRope"0", toRope"0", toRope"0", length,
+                        genNodeList(m, sons))
+  genTypeInfoAuxBase(m, typ, name, toRope("0"), node)
 
 proc genEnumInfo(m: BModule, typ: PType, name: PRope) =
   # Type information for enumerations is quite heavy, so we do some
   # optimizations here: The ``typ`` field is never set, as it is redundant
-  # anyway. We generate a cstring array and a loop over it. Exceptional
-  # positions will be reset after the loop.
-  genTypeInfoAux(m, typ, name)
-  var nodePtrs = getTempName()
+  # anyway, and the field nodes are kept in a single array.
   var length = sonsLen(typ.n)
-  appf(m.s[cfsTypeInit1], "static TNimNode* $1[$2];$n", 
-       [nodePtrs, toRope(length)])
-  var enumNames, specialCases: PRope
-  var firstNimNode = m.typeNodes
-  var hasHoles = false
+  var elems = getTempName()
+  var enumNodes, nodePtrs: PRope
+  var flags = 0
   for i in countup(0, length - 1): 
     assert(typ.n.sons[i].kind == nkSym)
     var field = typ.n.sons[i].sym
-    var elemNode = getNimNode(m)
+    var fieldName: PRope
     if field.ast == nil:
       # no explicit string literal for the enum field, so use field.name:
-      app(enumNames, makeCString(field.name.s))
+      fieldName = makeCString(field.name.s)
     else:
-      app(enumNames, makeCString(field.ast.strVal))
-    if i < length - 1: app(enumNames, ", " & tnl)
+      fieldName = makeCString(field.ast.strVal)
     if field.position != i or tfEnumHasHoles in typ.flags:
-      appf(specialCases, "$1.offset = $2;$n", [elemNode, toRope(field.position)])
-      hasHoles = true
-  var enumArray = getTempName()
-  var counter = getTempName()
-  appf(m.s[cfsTypeInit1], "NI $1;$n", [counter])
-  appf(m.s[cfsTypeInit1], "static char* NIM_CONST $1[$2] = {$n$3};$n", 
-       [enumArray, toRope(length), enumNames])
-  appf(m.s[cfsTypeInit3], "for ($1 = 0; $1 < $2; $1++) {$n" &
-      "$3[$1+$4].kind = 1;$n" & "$3[$1+$4].offset = $1;$n" &
-      "$3[$1+$4].name = $5[$1];$n" & "$6[$1] = &$3[$1+$4];$n" & "}$n", [counter, 
-      toRope(length), m.typeNodesName, toRope(firstNimNode), enumArray, nodePtrs])
-  app(m.s[cfsTypeInit3], specialCases)
-  appf(m.s[cfsTypeInit3], 
-       "$1.len = $2; $1.kind = 2; $1.sons = &$3[0];$n$4.node = &$1;$n", 
-       [getNimNode(m), toRope(length), nodePtrs, name])
-  if hasHoles:
-    # 1 << 2 is {ntfEnumHole}
-    appf(m.s[cfsTypeInit3], "$1.flags = 1<<2;$n", [name])
+      # 1 << 2 is {ntfEnumHole}
+      flags = 1 shl 2
+    if i > 0: 
+      app(enumNodes, "," & tnl)
+      app(nodePtrs, ", ")
+    appf(enumNodes, "{1, $1, 0, $2, 0, 0}", [toRope(field.position), fieldName])
+    appf(nodePtrs, "&$1[$2]", [elems, toRope(i)])
+  var sons = getTempName()
+  discard cgsym(m, "TNimNode")
+  appf(m.s[cfsVars], "static TNimNode $1[$2] = {$n$3};$n" &
+       "static TNimNode* $4[$2] = {$5};$n",
+       [elems, toRope(length), enumNodes, sons, nodePtrs])
+  var node = genNimNode(m, 2, toRope"0", toRope"0", toRope"0", length, sons)
+  genTypeInfoAux(m, typ, name, node, flags)
 
 proc genSetInfo(m: BModule, typ: PType, name: PRope) = 
   assert(typ.sons[0] != nil)
-  genTypeInfoAux(m, typ, name)
-  var tmp = getNimNode(m)
-  appf(m.s[cfsTypeInit3], "$1.len = $2; $1.kind = 0;$n" & "$3.node = &$1;$n", 
-       [tmp, toRope(firstOrd(typ)), name])
+  var node = genNimNode(m, 0, toRope"0", toRope"0", toRope"0", firstOrd(typ),
+                        nil)
+  genTypeInfoAux(m, typ, name, node)
 
 proc genArrayInfo(m: BModule, typ: PType, name: PRope) = 
   genTypeInfoAuxBase(m, typ, name, genTypeInfo(m, typ.sons[1]))
@@ -923,6 +940,11 @@ proc genTypeInfo(m: BModule, t: PType): PRope =
     appf(m.s[cfsVars], "extern TNimType $1; /* $2 */$n", 
          [result, toRope(typeToString(t))])
     return con("(&".toRope, result, ")".toRope)
+  if t.kind != tyEmpty:
+    # the parts of a recursive type refer to its type info before it is
+    # defined:
+    discard cgsym(m, "TNimType")
+    appf(m.s[cfsVars], "extern TNimType $1;$n", [result])
   case t.kind
   of tyEmpty: result = toRope"0"
   of tyPointer, tyBool, tyChar, tyCString, tyString, tyInt..tyUInt64, tyVar:
@@ -269,6 +269,14 @@ proc genCLineDir(r: var PRope, filename: string, line: int) =
 proc genCLineDir(r: var PRope, info: TLineInfo) = 
   genCLineDir(r, info.toFullPath, info.safeLineNm)
 
+proc addLoc(p: BProc, info: TLineInfo, line: int): int =
+  # the pre, post and main init procs end up in the same C function and
+  # thus share the location table of the frame descriptor:
+  let q = if p.prc == nil: p.module.initProc else: p
+  inc(q.locsLen)
+  appf(q.locs, "{$1, $2},$n", [info.quotedFilename, line.toRope])
+  result = q.locsLen
+
 proc genLineDir(p: BProc, t: PNode) =
   var line = t.info.safeLineNm
   if optEmbedOrigSrc in gGlobalOptions:
@@ -281,8 +289,11 @@ proc genLineDir(p: BProc, t: PNode) =
   elif ({optLineTrace, optStackTrace} * p.Options ==
       {optLineTrace, optStackTrace}) and
       (p.prc == nil or sfPure notin p.prc.flags):
-    linefmt(p, cpsStmts, "nimln($1, $2);$n",
-            line.toRope, t.info.quotedFilename)
+    if optStaticFrames in gGlobalOptions:
+      linefmt(p, cpsStmts, "nimloc($1);$n", addLoc(p, t.info, line).toRope)
+    else:
+      linefmt(p, cpsStmts, "nimln($1, $2);$n",
+              line.toRope, t.info.quotedFilename)
 
 proc accessThreadLocalVar(p: BProc, s: PSym)
 proc emulatedThreadVars(): bool {.inline.}
@@ -489,7 +500,9 @@ proc assignLocalVar(p: BProc, s: PSym) =
     if sfRegister in s.flags: app(decl, " register")
     #elif skipTypes(s.typ, abstractInst).kind in GcTypeKinds:
     #  app(decl, " GC_GUARD")
-    if sfVolatile in s.flags or p.nestedTryStmts.len > 0: 
+    if sfVolatile in s.flags or p.nestedTryStmts.len > 0 and
+        not zeroCostExceptions():
+      # locals that live across a 'setjmp' must be volatile
       app(decl, " volatile")
     appf(decl, " $1;$n", [s.loc.r])
   else:
@@ -717,7 +730,14 @@ proc retIsNotVoid(s: PSym): bool =
 
 proc initFrame(p: BProc, procname, filename: PRope): PRope =
   discard cgsym(p.module, "pushFrame")
-  if p.maxFrameLen > 0:
+  if optStaticFrames in gGlobalOptions:
+    # location 0 means 'no line yet'; the table must not be empty in C:
+    var locs = p.locs
+    if locs == nil: locs = ~"{0, 0}"
+    result = rfmt(nil, "\tstatic const TLineEntry FL[] = {$n$1};$n" &
+                       "\tstatic const TFrameDesc FD = {$2, $3, FL};$n" &
+                       "\tnimfrd(FD)$N", locs, procname, filename)
+  elif p.maxFrameLen > 0:
     discard cgsym(p.module, "TVarSlot")
     result = rfmt(nil, "\tnimfrs($1, $2, $3, $4)$N",
                   procname, filename, p.maxFrameLen.toRope,
@@ -896,6 +916,8 @@ proc genVarPrototype(m: BModule, sym: PSym) =
 proc addIntTypes(result: var PRope) {.inline.} =
   appf(result, "#define NIM_INTBITS $1", [
     platform.CPU[targetCPU].intSize.toRope])
+  if optStaticFrames in gGlobalOptions:
+    appf(result, "$N#define NIM_STATIC_FRAMES")
 
 proc getCopyright(cfilenoext: string): PRope = 
   if optCompileOnly in gGlobalOptions: 
@@ -993,9 +1015,15 @@ proc genMainProc(m: BModule) =
   let initStackBottomCall = if emulatedThreadVars() or
                               platform.targetOS == osStandalone: "".toRope
                             else: ropecg(m, "\t#initStackBottom();$n")
+  var modInit = mainModInit
+  if zeroCostExceptions():
+    # report what nobody catches just like the setjmp implementation does:
+    modInit = ropecg(m, "\ttry {$n$1\t} catch (NimException& e) {$n" &
+                        "\t\t#reportUnhandledException(e.exp);$n\t}$n",
+                     [mainModInit])
   inc(m.labels)
   appcg(m, m.s[cfsProcs], nimMain, [mainDatInit, initStackBottomCall,
-        gBreakpoints, mainModInit, toRope(m.labels)])
+        gBreakpoints, modInit, toRope(m.labels)])
   if optNoMain notin gGlobalOptions:
     appcg(m, m.s[cfsProcs], otherMain, [])
 
@@ -1024,13 +1052,6 @@ proc genInitCode(m: BModule) =
   var initname = getInitName(m.module)
   var prc = ropeff("N_NOINLINE(void, $1)(void) {$n", 
                    "define void $1() noinline {$n", [initname])
-  if m.typeNodes > 0: 
-    appcg(m, m.s[cfsTypeInit1], "static #TNimNode $1[$2];$n", 
-          [m.typeNodesName, toRope(m.typeNodes)])
-  if m.nimTypes > 0: 
-    appcg(m, m.s[cfsTypeInit1], "static #TNimType $1[$2];$n", 
-          [m.nimTypesName, toRope(m.nimTypes)])
-  
   app(prc, initGCFrame(m.initProc))
  
   app(prc, genSectionStart(cpsLocals))
@@ -1046,6 +1067,8 @@ proc genInitCode(m: BModule) =
     if not m.PreventStackTrace:
       var procname = CStringLit(m.initProc, prc, m.module.name.s)
       app(prc, initFrame(m.initProc, procname, m.module.info.quotedFilename))
+    elif optStaticFrames in gGlobalOptions:
+      app(prc, ~"\tTFrame F; F.loc = 0;$N")
     else:
       app(prc, ~"\tTFrame F; F.len = 0;$N")
     
@@ -1126,8 +1149,6 @@ proc rawNewModule(module: PSym, filename: string): BModule =
   initNodeTable(result.dataCache)
   result.typeStack = @[]
   result.forwardedProcs = @[]
-  result.typeNodesName = getTempName()
-  result.nimTypesName = getTempName()
   result.PreventStackTrace = sfSystemModule in module.flags
 
 proc nullify[T](arr: var T) =
@@ -1147,13 +1168,9 @@ proc resetModule*(m: var BModule) =
   initNodeTable(m.dataCache)
   m.typeStack = @[]
   m.forwardedProcs = @[]
-  m.typeNodesName = getTempName()
-  m.nimTypesName = getTempName()
   m.PreventStackTrace = sfSystemModule in m.module.flags
   nullify m.s
   m.usesThreadVars = false
-  m.typeNodes = 0
-  m.nimTypes = 0
   nullify m.extensionLoaders
   
   # indicate that this is now cached module
@@ -80,6 +80,8 @@ type
     withinLoop*: int          # > 0 if we are within a loop
     gcFrameId*: natural       # for the GC stack marking
     gcFrameType*: PRope       # the struct {} we put the GC markers into
+    locs*: PRope              # {file, line} entries of the static frame
+    locsLen*: int             # descriptor; see ``--staticFrames``
   
   TTypeSeq* = seq[PType]
   TCGen = object of TPassContext # represents a C source file
@@ -105,8 +107,6 @@ type
     typeStack*: TTypeSeq      # used for type generation
     dataCache*: TNodeTable
     forwardedProcs*: TSymSeq  # keep forwarded procs here
-    typeNodes*, nimTypes*: int # used for type info generation
-    typeNodesName*, nimTypesName*: PRope # used for type info generation
     labels*: natural          # for generating unique module-scope names
     extensionLoaders*: array['0'..'9', PRope] # special procs for the
                                               # OpenGL wrapper
@@ -143,6 +143,42 @@ proc sortBucket(a: var TSymSeq, relevantCols: TIntSet) =
       a[j] = v
     if h == 1: break 
   
+const
+  maxTableCols = 2 # the method cache is keyed by at most 2 dynamic types
+
+proc canUseTable(base: PSym, relevantCols: TIntSet): bool =
+  # the cache reads the type field through the argument, so only 'ref' and
+  # 'ptr' columns qualify; the JS backend has no such type field:
+  if gMethodDispatch != mdTable or gCmd == cmdCompileToJS: return false
+  if getCompilerProc("methodSlot") == nil: return false
+  var cols = 0
+  for col in countup(1, sonsLen(base.typ) - 1):
+    if Contains(relevantCols, col):
+      var t = skipTypes(base.typ.sons[col], abstractInst)
+      if t.kind notin {tyRef, tyPtr}: return false
+      if isPureObject(skipTypes(t.sons[0], abstractInst)): return false
+      inc(cols)
+  result = cols > 0 and cols <= maxTableCols
+
+proc newMethodCache(base: PSym): PSym =
+  result = newSym(skVar, getIdent("methodCache"), base, base.info)
+  result.typ = getCompilerProc("TMethodCache").typ
+  incl(result.flags, sfGlobal)
+  # the cache is not synchronized, so every thread gets its own:
+  if optThreads in gGlobalOptions: incl(result.flags, sfThread)
+
+proc newCacheCall(name: string, cache, base: PSym, relevantCols: TIntSet,
+                  typ: PType): PNode =
+  result = newNodeIT(nkCall, base.info, typ)
+  addSon(result, newSymNode(getCompilerProc(name)))
+  addSon(result, newSymNode(cache))
+  for col in countup(1, sonsLen(base.typ) - 1):
+    if Contains(relevantCols, col):
+      addSon(result, newSymNode(base.typ.n.sons[col].sym))
+  # single dispatch: the second key is always nil
+  if sonsLen(result) < maxTableCols + 2:
+    addSon(result, newNodeIT(nkNilLit, base.info, getSysType(tyNil)))
+
 proc genDispatcher(methods: TSymSeq, relevantCols: TIntSet): PSym =
   var base = lastSon(methods[0].ast).sym
   result = base
@@ -150,6 +186,19 @@ proc genDispatcher(methods: TSymSeq, relevantCols: TIntSet): PSym =
   var disp = newNodeI(nkIfStmt, base.info)
   var ands = getSysSym("and")
   var iss = getSysSym("of")
+  # with a method cache the dispatcher becomes:
+  #   case methodSlot(cache, a, b)
+  #   of 0: return m0(a, b)
+  #   ...
+  #   else: <if chain that calls 'cacheMethodSlot' for the chosen method>
+  var useTable = canUseTable(base, relevantCols)
+  var cache: PSym
+  var jumps: PNode
+  if useTable:
+    cache = newMethodCache(base)
+    jumps = newNodeI(nkCaseStmt, base.info)
+    addSon(jumps, newCacheCall("methodSlot", cache, base, relevantCols,
+                               getSysType(tyInt)))
   for meth in countup(0, high(methods)):
     var curr = methods[meth]      # generate condition:
     var cond: PNode = nil
@@ -181,6 +230,18 @@ proc genDispatcher(methods: TSymSeq, relevantCols: TIntSet): PSym =
       addSon(ret, a)
     else:
       ret = call
+    if useTable:
+      var branch = newNodeI(nkOfBranch, base.info)
+      addSon(branch, newIntTypeNode(nkIntLit, meth, getSysType(tyInt)))
+      addSon(branch, copyTree(ret))
+      addSon(jumps, branch)
+      var store = newCacheCall("cacheMethodSlot", cache, base, relevantCols,
+                               nil)
+      addSon(store, newIntTypeNode(nkIntLit, meth, getSysType(tyInt)))
+      var a = newNodeI(nkStmtList, base.info)
+      addSon(a, store)
+      addSon(a, ret)
+      ret = a
     if cond != nil:
       var a = newNodeI(nkElifBranch, base.info)
       addSon(a, cond)
@@ -188,6 +249,19 @@ proc genDispatcher(methods: TSymSeq, relevantCols: TIntSet): PSym =
       addSon(disp, a)
     else:
       disp = ret
+  if useTable:
+    var a = newNodeI(nkElse, base.info)
+    addSon(a, disp)
+    addSon(jumps, a)
+    var def = newNodeI(nkIdentDefs, base.info)
+    addSon(def, newSymNode(cache))
+    addSon(def, ast.emptyNode)
+    addSon(def, ast.emptyNode)
+    var v = newNodeI(nkVarSection, base.info)
+    addSon(v, def)
+    disp = newNodeI(nkStmtList, base.info)
+    addSon(disp, v)
+    addSon(disp, jumps)
   result.ast.sons[bodyPos] = disp
 
 proc generateMethodDispatchers*(): PNode = 
@@ -169,6 +169,8 @@ proc testCompileOption*(switch: string, info: TLineInfo): bool =
   of "warnings", "w": result = contains(gOptions, optWarns)
   of "hints": result = contains(gOptions, optHints)
   of "threadanalysis": result = contains(gGlobalOptions, optThreadAnalysis)
+  of "stackalloc": result = contains(gGlobalOptions, optStackAlloc)
+  of "staticframes": result = contains(gGlobalOptions, optStaticFrames)
   of "stacktrace": result = contains(gOptions, optStackTrace)
   of "linetrace": result = contains(gOptions, optLineTrace)
   of "debugger": result = contains(gOptions, optEndb)
@@ -320,11 +322,35 @@ proc processSwitch(switch, arg: string, pass: TCmdlinePass, info: TLineInfo) =
       gSelectedGC = gcNone
       defineSymbol("nogc")
     else: LocalError(info, errNoneBoehmRefcExpectedButXFound, arg)
+  of "methoddispatch":
+    expectArg(switch, arg, pass, info)
+    case arg.normalize
+    of "table": gMethodDispatch = mdTable
+    of "ifchain": gMethodDispatch = mdIfChain
+    else: LocalError(info, errGenerated,
+      "'table' or 'ifchain' expected, but found " & arg)
+  of "exceptions":
+    expectArg(switch, arg, pass, info)
+    case arg.normalize
+    of "setjmp": gExceptionMode = excSetjmp
+    of "zerocost": gExceptionMode = excZeroCost
+    else: LocalError(info, errGenerated,
+      "'setjmp' or 'zerocost' expected, but found " & arg)
   of "warnings", "w": ProcessOnOffSwitch({optWarns}, arg, pass, info)
   of "warning": ProcessSpecificNote(arg, wWarning, pass, info)
   of "hint": ProcessSpecificNote(arg, wHint, pass, info)
   of "hints": ProcessOnOffSwitch({optHints}, arg, pass, info)
+  of "casestats":
+    case whichKeyword(arg)
+    of wOn: incl(gNotes, hintCaseStats)
+    of wOff: excl(gNotes, hintCaseStats)
+    else: LocalError(info, errOnOrOffExpectedButXFound, arg)
   of "threadanalysis": ProcessOnOffSwitchG({optThreadAnalysis}, arg, pass, info)
+  of "stackalloc": ProcessOnOffSwitchG({optStackAlloc}, arg, pass, info)
+  of "staticframes":
+    ProcessOnOffSwitchG({optStaticFrames}, arg, pass, info)
+    if optStaticFrames in gGlobalOptions: DefineSymbol("staticframes")
+    else: UndefSymbol("staticframes")
   of "stacktrace": ProcessOnOffSwitch({optStackTrace}, arg, pass, info)
   of "linetrace": ProcessOnOffSwitch({optLineTrace}, arg, pass, info)
   of "debugger": 
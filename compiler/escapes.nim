@@ -0,0 +1,112 @@
+#
+#
+#           The Nimrod Compiler
+#        (c) Copyright 2013 Andreas Rumpf
+#
+#    See the file "copying.txt", included in this
+#    distribution, for details about the copyright.
+#
+
+## This module implements a simple intraprocedural escape analysis. A local
+## ``ref`` variable whose object is created via ``new(x)`` and which is only
+## ever dereferenced, compared or tested with ``of``/``isNil`` cannot outlive
+## the proc's stack frame; such a variable is marked with ``sfStackAlloc``
+## and the code generator then allocates its object on the C stack instead
+## of the GC'ed heap.
+
+import
+  intsets, ast, astalgo, msgs, types, trees
+
+const
+  maxStackAllocSize = 1024 # objects bigger than this stay on the heap
+
+type
+  TEscapeCtx = object
+    escaped: TIntSet      # candidate ids that (may) escape
+    news: seq[PSym]       # candidates that are created via 'new(x)'
+
+proc isCandidate(owner, v: PSym): bool =
+  if v.kind != skVar or v.owner != owner: return false
+  if {sfGlobal, sfThread, sfAddrTaken} * v.flags != {}: return false
+  let t = skipTypes(v.typ, abstractInst)
+  if t.kind != tyRef: return false
+  let obj = skipTypes(t.sons[0], abstractInst)
+  if obj.kind != tyObject or tfIncompleteStruct in obj.flags: return false
+  if containsGarbageCollectedRef(obj): return false
+  let size = computeSize(obj)
+  result = size > 0 and size <= maxStackAllocSize
+
+proc escapeAll(c: var TEscapeCtx, n: PNode) =
+  case n.kind
+  of nkSym: incl(c.escaped, n.sym.id)
+  of nkEmpty..pred(nkSym), succ(nkSym)..nkNilLit: nil
+  else:
+    for i in 0 .. <n.len: escapeAll(c, n.sons[i])
+
+proc directSym(n: PNode): PNode =
+  result = n
+  if result.kind == nkHiddenAddr: result = result.sons[0]
+  if result.kind != nkSym: result = nil
+
+proc analyse(c: var TEscapeCtx, n: PNode)
+
+proc analyseSons(c: var TEscapeCtx, n: PNode, start = 0) =
+  for i in start .. <n.len: analyse(c, n.sons[i])
+
+proc analyseCall(c: var TEscapeCtx, n: PNode) =
+  case getMagic(n)
+  of mNew:
+    let s = directSym(n.sons[1])
+    if n.len == 2 and s != nil: c.news.add(s.sym)
+    else: analyseSons(c, n, 1)
+  of mOf, mIsNil, mEqRef:
+    # these only inspect the pointer or the type field:
+    for i in 1 .. <n.len:
+      if n.sons[i].kind != nkSym: analyse(c, n.sons[i])
+  else:
+    analyseSons(c, n)
+
+proc analyse(c: var TEscapeCtx, n: PNode) =
+  case n.kind
+  of nkSym: incl(c.escaped, n.sym.id)
+  of nkEmpty..pred(nkSym), succ(nkSym)..nkNilLit, nkTypeSection,
+     nkConstSection, nkPragma:
+    nil
+  of nkHiddenDeref, nkDerefExpr:
+    # 'x[]' and 'x.field' do not let the pointer escape:
+    if n.sons[0].kind != nkSym: analyse(c, n.sons[0])
+  of nkAddr:
+    escapeAll(c, n.sons[0])
+  of nkHiddenAddr:
+    # passing 'x' itself to a 'var' parameter may let it escape, passing the
+    # dereferenced object 'x[]' does not:
+    if n.sons[0].kind == nkSym: incl(c.escaped, n.sons[0].sym.id)
+    else: analyse(c, n.sons[0])
+  of nkCallKinds:
+    analyseCall(c, n)
+  of nkAsgn, nkFastAsgn:
+    # overwriting 'x' is harmless, reading it is not:
+    if n.sons[0].kind != nkSym: analyse(c, n.sons[0])
+    analyse(c, n.sons[1])
+  of nkIdentDefs, nkVarTuple:
+    # only the initial value is read:
+    analyse(c, n.sons[n.len-1])
+  of nkProcDef, nkMethodDef, nkConverterDef, nkMacroDef, nkTemplateDef,
+     nkIteratorDef, nkLambdaKinds:
+    # be conservative with nested routines:
+    escapeAll(c, n)
+  else:
+    analyseSons(c, n)
+
+proc markStackAllocs*(owner: PSym, body: PNode) =
+  ## marks every local ``ref`` variable of `owner` whose object provably
+  ## does not escape `body` with ``sfStackAlloc``.
+  var c: TEscapeCtx
+  c.escaped = initIntSet()
+  c.news = @[]
+  analyse(c, body)
+  for v in c.news:
+    if isCandidate(owner, v) and not c.escaped.contains(v.id) and
+        sfStackAlloc notin v.flags:
+      incl(v.flags, sfStackAlloc)
+      Message(v.info, hintStackAlloc, v.name.s)
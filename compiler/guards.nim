@@ -484,7 +484,8 @@ proc factImplies(fact, prop: PNode): TImplication =
       if a == b: return ~a
       return impUnknown
     else:
-      InternalError(fact.info, "invalid fact")
+      # 'not (x == 4)' is a valid fact, but it implies nothing we can use:
+      return impUnknown
   of mAnd:
     result = factImplies(fact.sons[1], prop)
     if result != impUnknown: return result
@@ -511,6 +512,130 @@ proc doesImply*(facts: TModel, prop: PNode): TImplication =
 proc impliesNotNil*(facts: TModel, arg: PNode): TImplication =
   result = doesImply(facts, buildIsNil(arg).neg)
 
+proc skipHidden(n: PNode): PNode =
+  result = n
+  while true:
+    case result.kind
+    of nkHiddenDeref: result = result.sons[0]
+    of nkHiddenStdConv, nkHiddenSubConv: result = result.sons[1]
+    else: break
+
+proc isLengthOf(n, arr: PNode): bool =
+  # 'n' is 'len(arr)'
+  result = n.getMagic in someLen and sameTree(n.sons[1].skipHidden, arr)
+
+proc isHighOf(n, arr: PNode): bool =
+  # 'n' is 'high(arr)' or 'len(arr)-1'
+  case n.getMagic
+  of mHigh:
+    result = sameTree(n.sons[1].skipHidden, arr)
+  of mSubI, mSubI64:
+    let one = n.sons[2].skipConv
+    result = one.kind in {nkCharLit..nkUInt64Lit} and one.intVal == 1 and
+             isLengthOf(n.sons[1], arr)
+  else: result = false
+
+proc impliesBelowLen(fact, idx, arr: PNode): bool =
+  case fact.getMagic
+  of mAnd:
+    result = impliesBelowLen(fact.sons[1], idx, arr) or
+             impliesBelowLen(fact.sons[2], idx, arr)
+  of someLt:
+    result = sameTree(fact.sons[1].skipHidden, idx) and
+             isLengthOf(fact.sons[2], arr)
+  of someLe:
+    result = sameTree(fact.sons[1].skipHidden, idx) and
+             isHighOf(fact.sons[2], arr)
+  else: result = false
+
+proc buildLe(a, b: PNode): PNode =
+  result = newNodeI(nkCall, a.info, 3)
+  result.sons[0] = newSymNode(getSysMagic("<=", mLeI))
+  result.sons[1] = a
+  result.sons[2] = b
+
+proc provesGe(facts: TModel, x: PNode, c: biggestInt): bool =
+  # x >= c?
+  if x.isValue: result = x.intVal >= c
+  elif firstOrd(x.typ) >= c: result = true
+  else:
+    result = doesImply(facts, buildLe(newIntNode(nkIntLit, c), x)) == impYes
+
+proc provesLe(facts: TModel, x: PNode, c: biggestInt): bool =
+  # x <= c?
+  if x.isValue: result = x.intVal <= c
+  elif lastOrd(x.typ) <= c: result = true
+  else:
+    result = doesImply(facts, buildLe(x, newIntNode(nkIntLit, c))) == impYes
+
+proc impliesInBounds*(facts: TModel, arr, idx: PNode): bool =
+  ## checks that the index `idx` of the access ``arr[idx]`` is in range. The
+  ## caller ensures the length of `arr` cannot change without invalidating
+  ## the facts that mention it.
+  let t = skipTypes(arr.typ, abstractVarRange)
+  case t.kind
+  of tyArray, tyArrayConstr:
+    let it = t.sons[0]
+    result = provesGe(facts, idx, firstOrd(it)) and
+             provesLe(facts, idx, lastOrd(it))
+  of tyOpenArray, tyVarargs, tySequence, tyString:
+    if not provesGe(facts, idx, 0): return false
+    let a = arr.skipHidden
+    for f in facts:
+      if not f.isNil and impliesBelowLen(f, idx, a): return true
+  else: nil
+
+proc hasLength(n: PNode): bool =
+  if n.getMagic in someLen + {mHigh}: return true
+  for i in 0 .. <safeLen(n):
+    if hasLength(n.sons[i]): return true
+
+proc canReachHeap(t: PType): bool =
+  result = t.kind in {tyRef, tyPtr, tyPointer, tyVar, tySequence, tyString,
+                      tyOpenArray, tyVarargs}
+
+proc invalidateCall*(m: var TModel, n: PNode) =
+  ## invalidates the facts the call `n` may change: the ones about the
+  ## arguments passed to ``var`` parameters and, unless the call is free of
+  ## side effects and its arguments cannot reach the heap, the ones about the
+  ## length of any seq or string.
+  let op = n.sons[0]
+  let magic = op.kind == nkSym and op.sym.magic != mNone
+  var lengths = not (magic or op.kind == nkSym and
+      sfNoSideEffect in op.sym.flags or
+      op.typ != nil and tfNoSideEffect in op.typ.flags)
+  for i in 1 .. <n.len:
+    let arg = n.sons[i]
+    if arg.kind in {nkHiddenAddr, nkAddr}:
+      invalidateFacts(m, arg.sons[0])
+      if containsGarbageCollectedRef(arg.sons[0].typ): lengths = true
+    elif arg.typ != nil and arg.typ.kind == tyVar:
+      # a 'var' parameter passed on is not wrapped in nkHiddenAddr
+      invalidateFacts(m, arg)
+      if containsGarbageCollectedRef(arg.typ.sons[0]): lengths = true
+    elif not magic and (arg.typ == nil or
+        searchTypeFor(arg.typ, canReachHeap)):
+      # 'noSideEffect' still allows writes through refs and pointers, and
+      # seq and string parameters share their buffer with the caller
+      lengths = true
+  if lengths:
+    for i in 0..high(m):
+      if m[i] != nil and hasLength(m[i]): m[i] = nil
+
+proc invalidateWrites*(m: var TModel, n: PNode) =
+  ## invalidates the facts about every location `n` may write to. This is
+  ## used when control can reach a point again after `n` ran (loops) or
+  ## after `n` ran only partially (exception handlers).
+  case n.kind
+  of nkAsgn, nkFastAsgn:
+    invalidateFacts(m, n.sons[0])
+  of nkIdentDefs, nkVarTuple:
+    for i in 0 .. n.len-3: invalidateFacts(m, n.sons[i])
+  of nkCallKinds:
+    invalidateCall(m, n)
+  else: nil
+  for i in 0 .. <safeLen(n): invalidateWrites(m, n.sons[i])
+
 proc settype(n: PNode): PType =
   result = newType(tySet, n.typ.owner)
   addSonSkipIntLit(result, n.typ)
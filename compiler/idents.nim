@@ -22,33 +22,27 @@ type
   PIdent* = ref TIdent
   TIdent*{.acyclic.} = object of TIdObj
     s*: string
-    next*: PIdent             # for hash-table chaining
+    key: string               # `s` in lower case and without underscores;
+                              # shares `s` if that is already the case
     h*: THash                 # hash value of s
 
 var firstCharIsCS*: bool
-var buckets*: array[0..4096 * 2 - 1, PIdent]
 
-proc cmpIgnoreStyle(a, b: cstring, blen: int): int =
-  if firstCharIsCS:
-    if a[0] != b[0]: return 1
-  var i = 0
-  var j = 0
-  result = 1
-  while j < blen:
-    while a[i] == '_': inc(i)
-    while b[j] == '_': inc(j)
-    # tolower inlined:
-    var aa = a[i]
-    var bb = b[j]
-    if aa >= 'A' and aa <= 'Z': aa = chr(ord(aa) + (ord('a') - ord('A')))
-    if bb >= 'A' and bb <= 'Z': bb = chr(ord(bb) + (ord('a') - ord('A')))
-    result = ord(aa) - ord(bb)
-    if (result != 0) or (aa == '\0'): break 
-    inc(i)
-    inc(j)
-  if result == 0:
-    if a[i] != '\0': result = 1
-  
+const
+  StartSize = 8192
+
+# open addressing; the hash is style insensitive so that identifiers which
+# only differ in style end up in the same probe sequence:
+var
+  identTable: seq[PIdent]
+  identCounter: int
+
+proc resetIdentTable*() =
+  newSeq(identTable, StartSize)
+  identCounter = 0
+
+resetIdentTable()
+
 proc cmpExact(a, b: cstring, blen: int): int =
   var i = 0
   var j = 0
@@ -63,32 +57,61 @@ proc cmpExact(a, b: cstring, blen: int): int =
   if result == 0: 
     if a[i] != '\0': result = 1
 
+proc styleKey(s: cstring, length: int): string =
+  result = newStringOfCap(length)
+  for i in countup(0, length - 1):
+    var c = s[i]
+    if c != '_':
+      if c >= 'A' and c <= 'Z': c = chr(ord(c) + (ord('a') - ord('A')))
+      add(result, c)
+
+proc mustRehash(length, counter: int): bool {.inline.} =
+  result = (length * 2 < counter * 3) or (length - counter < 4)
+
+proc nextTry(h, maxHash: THash): THash {.inline.} =
+  result = ((5 * h) + 1) and maxHash
+
+proc identRawInsert(data: var seq[PIdent], item: PIdent) =
+  var h = item.h and high(data)
+  while data[h] != nil: h = nextTry(h, high(data))
+  data[h] = item
+
+proc identEnlarge() =
+  var n: seq[PIdent]
+  newSeq(n, len(identTable) * 2)
+  for i in countup(0, high(identTable)):
+    if identTable[i] != nil: identRawInsert(n, identTable[i])
+  swap(identTable, n)
+
 var wordCounter = 1
 
 proc getIdent*(identifier: cstring, length: int, h: THash): PIdent =
-  var idx = h and high(buckets)
-  result = buckets[idx]
-  var last: PIdent = nil
+  var idx = h and high(identTable)
   var id = 0
-  while result != nil: 
-    if cmpExact(cstring(result.s), identifier, length) == 0: 
-      if last != nil: 
-        # make access to last looked up identifier faster:
-        last.next = result.next
-        result.next = buckets[idx]
-        buckets[idx] = result
-      return 
-    elif cmpIgnoreStyle(cstring(result.s), identifier, length) == 0:
-      assert((id == 0) or (id == result.id))
-      id = result.id
-    last = result
-    result = result.next
+  var key: string = nil
+  while identTable[idx] != nil:
+    result = identTable[idx]
+    # compare the hash and the length first; the style insensitive key is
+    # only computed when the hash collides:
+    if result.h == h:
+      if len(result.s) == length and 
+          cmpExact(cstring(result.s), identifier, length) == 0:
+        return
+      if id == 0 and 
+          (not firstCharIsCS or cstring(result.s)[0] == identifier[0]):
+        if key.isNil: key = styleKey(identifier, length)
+        if result.key == key: id = result.id
+    idx = nextTry(idx, high(identTable))
   new(result)
   result.h = h
   result.s = newString(length)
   for i in countup(0, length - 1): result.s[i] = identifier[i]
-  result.next = buckets[idx]
-  buckets[idx] = result
+  if key.isNil: key = styleKey(identifier, length)
+  if key == result.s: shallowCopy(result.key, result.s)
+  else: shallowCopy(result.key, key)
+  identTable[idx] = result
+  inc(identCounter)
+  if mustRehash(len(identTable), identCounter): identEnlarge()
   if id == 0: 
     inc(wordCounter)
     result.id = -wordCounter
@@ -518,6 +518,13 @@ proc HandleCRLF(L: var TLexer, pos: int): int =
     result = nimlexbase.HandleLF(L, pos)
   else: result = pos
   
+proc addSlice(dest: var string, buf: cstring, first, last: int) {.inline.} =
+  # appends ``buf[first..last-1]`` in one go instead of char by char
+  if last > first:
+    let oldLen = len(dest)
+    setLen(dest, oldLen + last - first)
+    copyMem(addr(dest[oldLen]), addr(buf[first]), last - first)
+
 proc getString(L: var TLexer, tok: var TToken, rawMode: bool) = 
   var pos = L.bufPos + 1          # skip "
   var buf = L.buf                 # put `buf` in a register
@@ -548,8 +555,9 @@ proc getString(L: var TLexer, tok: var TToken, rawMode: bool) =
         L.LineNumber = line2
         break 
       else: 
-        add(tok.literal, buf[pos])
-        Inc(pos)
+        var start = pos
+        while buf[pos] notin {'\"', CR, LF, nimlexbase.EndOfFile}: inc(pos)
+        addSlice(tok.literal, buf, start, pos)
   else: 
     # ordinary string literal
     if rawMode: tok.tokType = tkRStrLit
@@ -571,8 +579,12 @@ proc getString(L: var TLexer, tok: var TToken, rawMode: bool) =
         getEscapedChar(L, tok)
         pos = L.bufPos
       else: 
-        add(tok.literal, c)
-        Inc(pos)
+        # in raw mode the run may start with a backslash:
+        var start = pos
+        inc(pos)
+        while buf[pos] notin {'\"', '\\', CR, LF, nimlexbase.EndOfFile}: 
+          inc(pos)
+        addSlice(tok.literal, buf, start, pos)
     L.bufpos = pos
 
 proc getCharacter(L: var TLexer, tok: var TToken) = 
@@ -644,10 +656,11 @@ proc scanComment(L: var TLexer, tok: var TToken) =
   var col = getColNumber(L, pos)
   while true:
     var lastBackslash = -1
+    var start = pos
     while buf[pos] notin {CR, LF, nimlexbase.EndOfFile}:
       if buf[pos] == '\\': lastBackslash = pos+1
-      add(tok.literal, buf[pos])
       inc(pos)
+    addSlice(tok.literal, buf, start, pos)
     if lastBackslash > 0:
       # a backslash is a continuation character if only followed by spaces
       # plus a newline:
@@ -141,6 +141,20 @@ proc LLStreamRead(s: PLLStream, buf: pointer, bufLen: int): int =
   of llsStdIn: 
     result = LLreadFromStdin(s, buf, bufLen)
   
+proc LLStreamRemaining*(s: PLLStream): int =
+  ## the number of characters that are still to be read from `s` or -1 if
+  ## this is not known in advance.
+  case s.kind
+  of llsString: 
+    result = len(s.s) - s.rd
+  of llsFile: 
+    try:
+      result = int(getFileSize(s.f) - getFilePos(s.f))
+    except EIO:
+      result = -1
+  of llsNone, llsStdIn: 
+    result = -1
+
 proc LLStreamReadLine(s: PLLStream, line: var string): bool =
   setLen(line, 0)
   case s.kind
@@ -61,6 +61,11 @@ proc CommandDoc2 =
   finishDoc2Pass(gProjectName)
 
 proc CommandCompileToC =
+  if gExceptionMode == excZeroCost and gCmd != cmdCompileToCpp:
+    rawMessage(errGenerated, "'--exceptions:zerocost' needs the 'cpp' command")
+  if zeroCostExceptions(): DefineSymbol("zerocostexceptions")
+  if optStaticFrames in gGlobalOptions and optEndb in gOptions:
+    rawMessage(errGenerated, "'--staticFrames:on' cannot be used with ENDB")
   semanticPasses()
   registerPass(cgenPass)
   rodPass()
@@ -243,8 +248,8 @@ proc resetMemory =
   resetSysTypes()
   gOwners = @[]
   rangeDestructorProc = nil
-  for i in low(buckets)..high(buckets):
-    buckets[i] = nil
+  resetIdentTable()
+  resetComments()
   idAnon = nil
   
   # XXX: clean these global vars
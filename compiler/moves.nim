@@ -0,0 +1,137 @@
+#
+#
+#           The Nimrod Compiler
+#        (c) Copyright 2013 Andreas Rumpf
+#
+#    See the file "copying.txt", included in this
+#    distribution, for details about the copyright.
+#
+
+## This module implements a last read analysis for local strings and seqs:
+## an assignment ``x = y`` or an argument for a ``{.sink.}`` parameter that
+## reads ``y`` for the last time is marked with ``nfMove``; the code
+## generator then lets ``x`` steal ``y``'s buffer instead of copying it.
+## ``sink`` parameters own their argument and are treated like locals.
+
+import
+  intsets, ast, types, trees
+
+type
+  TUseKind = enum
+    ukDecl,       # the variable is declared here
+    ukRead,       # any other occurrence
+    ukMove,       # source of an assignment or a 'sink' argument
+    ukPoison      # the buffer may be shared: never move the variable
+
+  TUse = tuple[n: PNode, kind: TUseKind]
+
+  TMoveCtx = object
+    owner: PSym
+    uses: seq[TUse] # occurrences of candidates in evaluation order
+
+proc isCandidate(c: TMoveCtx, s: PSym): bool =
+  # 'let' variables and temporaries may share their buffer with a literal
+  result = s.owner == c.owner and
+    (s.kind == skVar or s.kind == skParam and sfSink in s.flags) and
+    {sfGlobal, sfThread, sfAddrTaken, sfNoInit} * s.flags == {} and
+    skipTypes(s.typ, abstractInst).kind in {tyString, tySequence}
+
+proc addUse(c: var TMoveCtx, n: PNode, kind: TUseKind) =
+  if n.kind == nkSym and isCandidate(c, n.sym): c.uses.add((n, kind))
+
+proc poisonAll(c: var TMoveCtx, n: PNode) =
+  case n.kind
+  of nkSym: addUse(c, n, ukPoison)
+  of nkEmpty..pred(nkSym), succ(nkSym)..nkNilLit: nil
+  else:
+    for i in 0 .. <n.len: poisonAll(c, n.sons[i])
+
+proc walk(c: var TMoveCtx, n: PNode)
+
+proc walkSource(c: var TMoveCtx, n: PNode) =
+  if n.kind == nkSym: addUse(c, n, ukMove)
+  else: walk(c, n)
+
+proc leaveLoop(c: var TMoveCtx, start: int) =
+  # a later iteration may read a variable again unless it is declared (and
+  # thus re-initialized) within the loop:
+  var inside = initIntSet()
+  for i in start .. <c.uses.len:
+    if c.uses[i].kind == ukDecl: incl(inside, c.uses[i].n.sym.id)
+  for i in start .. <c.uses.len:
+    if c.uses[i].kind == ukMove and not inside.contains(c.uses[i].n.sym.id):
+      c.uses[i].kind = ukRead
+
+proc walkCall(c: var TMoveCtx, n: PNode) =
+  if getMagic(n) == mShallowCopy:
+    poisonAll(c, n)
+    return
+  walk(c, n.sons[0])
+  var t = n.sons[0].typ
+  if t != nil: t = skipTypes(t, abstractInst)
+  for i in 1 .. <n.len:
+    if t != nil and t.kind == tyProc and i < t.n.len and t.n.sons[i].kind == nkSym and
+        sfSink in t.n.sons[i].sym.flags:
+      walkSource(c, n.sons[i])
+    else:
+      walk(c, n.sons[i])
+
+proc walk(c: var TMoveCtx, n: PNode) =
+  case n.kind
+  of nkSym: addUse(c, n, ukRead)
+  of nkEmpty..pred(nkSym), succ(nkSym)..nkNilLit, nkTypeSection,
+     nkConstSection, nkPragma:
+    nil
+  of nkAsgn:
+    walk(c, n.sons[0])
+    walkSource(c, n.sons[1])
+  of nkFastAsgn:
+    # a shallow copy: the destination shares the source's buffer
+    poisonAll(c, n.sons[0])
+    walk(c, n.sons[1])
+  of nkIdentDefs:
+    for i in 0 .. n.len-3: addUse(c, n.sons[i], ukDecl)
+    walkSource(c, n.sons[n.len-1])
+  of nkVarTuple:
+    for i in 0 .. n.len-3: addUse(c, n.sons[i], ukDecl)
+    walk(c, n.sons[n.len-1])
+  of nkAddr:
+    poisonAll(c, n.sons[0])
+  of nkCallKinds:
+    walkCall(c, n)
+  of nkWhileStmt, nkForStmt, nkParForStmt:
+    let start = c.uses.len
+    for i in 0 .. <n.len: walk(c, n.sons[i])
+    leaveLoop(c, start)
+  of nkProcDef, nkMethodDef, nkConverterDef, nkMacroDef, nkTemplateDef,
+     nkIteratorDef, nkLambdaKinds:
+    poisonAll(c, n)
+  else:
+    for i in 0 .. <n.len: walk(c, n.sons[i])
+
+proc markMoves*(owner: PSym, body: PNode) =
+  ## marks every read of a local string or seq in `body` that is the last
+  ## one and that can steal the buffer with ``nfMove``.
+  if owner.kind == skIterator or owner.typ == nil: return
+  var c: TMoveCtx
+  c.owner = owner
+  c.uses = @[]
+  var declared = initIntSet()
+  let params = owner.typ.n
+  for i in 1 .. <params.len:
+    if params.sons[i].kind == nkSym and isCandidate(c, params.sons[i].sym):
+      incl(declared, params.sons[i].sym.id)
+  walk(c, body)
+  var poisoned = initIntSet()
+  for u in c.uses:
+    case u.kind
+    of ukDecl: incl(declared, u.n.sym.id)
+    of ukPoison: incl(poisoned, u.n.sym.id)
+    else: nil
+  var seen = initIntSet()
+  for i in countdown(c.uses.len-1, 0):
+    let u = c.uses[i]
+    let id = u.n.sym.id
+    if not ContainsOrIncl(seen, id) and u.kind == ukMove and
+        declared.contains(id) and not poisoned.contains(id):
+      incl(u.n.flags, nfMove)
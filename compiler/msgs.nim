@@ -117,8 +117,8 @@ type
     hintLineTooLong, hintXDeclaredButNotUsed, hintConvToBaseNotNeeded,
     hintConvFromXtoItselfNotNeeded, hintExprAlwaysX, hintQuitCalled,
     hintProcessing, hintCodeBegin, hintCodeEnd, hintConf, hintPath,
-    hintConditionAlwaysTrue, hintPattern,
-    hintUser
+    hintConditionAlwaysTrue, hintPattern, hintCaseStats, hintStackAlloc,
+    hintBoundCheckElided, hintUser
 
 const 
   MsgKindToStr*: array[TMsgKind, string] = [
@@ -383,6 +383,9 @@ const
     hintPath: "added path: '$1' [Path]",
     hintConditionAlwaysTrue: "condition is always true: '$1' [CondTrue]",
     hintPattern: "$1 [Pattern]",
+    hintCaseStats: "case statement: $1 [CaseStats]",
+    hintStackAlloc: "'$1' is allocated on the stack [StackAlloc]",
+    hintBoundCheckElided: "'$1' needs no bound check [BoundCheckElided]",
     hintUser: "$1 [User]"]
 
 const
@@ -396,11 +399,11 @@ const
     "ImplicitClosure", "EachIdentIsTuple", "ShadowIdent", 
     "ProveInit", "ProveField", "ProveIndex", "Uninit", "User"]
 
-  HintsToStr*: array[0..15, string] = ["Success", "SuccessX", "LineTooLong", 
+  HintsToStr*: array[0..18, string] = ["Success", "SuccessX", "LineTooLong", 
     "XDeclaredButNotUsed", "ConvToBaseNotNeeded", "ConvFromXtoItselfNotNeeded", 
     "ExprAlwaysX", "QuitCalled", "Processing", "CodeBegin", "CodeEnd", "Conf", 
-    "Path", "CondTrue", "Pattern",
-    "User"]
+    "Path", "CondTrue", "Pattern", "CaseStats", "StackAlloc",
+    "BoundCheckElided", "User"]
 
 const 
   fatalMin* = errUnknown
@@ -529,7 +532,8 @@ proc sourceLine*(i: TLineInfo): PRope
 var
   gNotes*: TNoteKinds = {low(TNoteKind)..high(TNoteKind)} - 
                         {warnShadowIdent, warnUninit,
-                         warnProveField, warnProveIndex}
+                         warnProveField, warnProveIndex, hintCaseStats,
+                         hintStackAlloc, hintBoundCheckElided}
   gErrorCounter*: int = 0     # counts the number of errors
   gHintCounter*: int = 0
   gWarnCounter*: int = 0
@@ -10,7 +10,8 @@
 # Base Object of a lexer with efficient buffer handling. In fact
 # I believe that this is the most efficient method of buffer
 # handling that exists! Only at line endings checks are necessary
-# if the buffer needs refilling.
+# if the buffer needs refilling. Files and strings are read as a whole
+# so that no refilling happens at all.
 
 import 
   llstream, strutils
@@ -143,16 +144,29 @@ proc skip_UTF_8_BOM(L: var TBaseLexer) =
     inc(L.bufpos, 3)
     inc(L.lineStart, 3)
 
+proc readWholeInput(L: var TBaseLexer, size: int) =
+  # the whole input becomes a single buffer; the end marker is the sentinel
+  # and since it is no newline `fillBuffer` is never called:
+  L.bufLen = size + 1
+  L.buf = cast[cstring](alloc(L.bufLen * chrSize))
+  var charsRead = LLStreamRead(L.stream, L.buf, size * chrSize) div chrSize
+  L.buf[charsRead] = EndOfFile
+  L.sentinel = charsRead
+
 proc openBaseLexer(L: var TBaseLexer, inputstream: PLLStream, bufLen = 8192) = 
   assert(bufLen > 0)
   L.bufpos = 0
-  L.bufLen = bufLen
-  L.buf = cast[cstring](alloc(bufLen * chrSize))
-  L.sentinel = bufLen - 1
   L.lineStart = 0
   L.linenumber = 1            # lines start at 1
   L.stream = inputstream
-  fillBuffer(L)
+  var size = LLStreamRemaining(inputstream)
+  if size >= 0:
+    readWholeInput(L, size)
+  else:
+    L.bufLen = bufLen
+    L.buf = cast[cstring](alloc(bufLen * chrSize))
+    L.sentinel = bufLen - 1
+    fillBuffer(L)
   skip_UTF_8_BOM(L)
 
 proc getColNumber(L: TBaseLexer, pos: int): int = 
@@ -65,6 +65,8 @@ type                          # please make sure we have under 32 options
     optGenIndex               # generate index file for documentation;
     optEmbedOrigSrc           # embed the original source in the generated code
                               # also: generate header file
+    optStackAlloc             # allocate non-escaping objects on the stack
+    optStaticFrames           # stack frames refer to static descriptors
    
   TGlobalOptions* = set[TGlobalOption]
   TCommands* = enum           # Nimrod's commands
@@ -84,6 +86,13 @@ type                          # please make sure we have under 32 options
   TStringSeq* = seq[string]
   TGCMode* = enum             # the selected GC
     gcNone, gcBoehm, gcMarkAndSweep, gcRefc, gcV2, gcGenerational
+  TMethodDispatch* = enum     # how method dispatchers are generated
+    mdIfChain,                # test the overrides one after another
+    mdTable                   # cache the chosen override per dynamic type
+  TExceptionMode* = enum      # how exceptions are implemented in C code
+    excDefault,               # 'zerocost' for the C++ backend, else 'setjmp'
+    excSetjmp,                # every 'try' pushes a setjmp based safe point
+    excZeroCost               # C++ 'try' and 'throw': free unless we raise
 
 const
   ChecksOptions* = {optObjCheck, optFieldCheck, optRangeCheck, optNilCheck, 
@@ -94,10 +103,12 @@ var
                          optBoundsCheck, optOverflowCheck, optAssert, optWarns, 
                          optHints, optStackTrace, optLineTrace,
                          optPatterns, optNilCheck}
-  gGlobalOptions*: TGlobalOptions = {optThreadAnalysis}
+  gGlobalOptions*: TGlobalOptions = {optThreadAnalysis, optStackAlloc}
   gExitcode*: int8
   gCmd*: TCommands = cmdNone  # the command
   gSelectedGC* = gcRefc       # the selected GC
+  gMethodDispatch* = mdTable  # the selected dispatch strategy for methods
+  gExceptionMode* = excDefault # the selected exception implementation
   searchPaths*, lazyPaths*: TLinkedList
   outFile*: string = ""
   headerFile*: string = ""
@@ -114,6 +125,9 @@ var
 
 proc importantComments*(): bool {.inline.} = gCmd in {cmdDoc, cmdIdeTools}
 proc usesNativeGC*(): bool {.inline.} = gSelectedGC >= gcRefc
+proc zeroCostExceptions*(): bool {.inline.} =
+  result = gExceptionMode == excZeroCost or
+    gExceptionMode == excDefault and gCmd == cmdCompileToCpp
 
 template isWorkingWithDirtyBuffer*: expr =
   gDirtyBufferIdx != 0
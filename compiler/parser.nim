@@ -106,8 +106,7 @@ template sameOrNoInd(p): bool = p.tok.indent == p.currInd or p.tok.indent < 0
 proc rawSkipComment(p: var TParser, node: PNode) =
   if p.tok.tokType == tkComment:
     if node != nil:
-      if node.comment == nil: node.comment = ""
-      add(node.comment, p.tok.literal)
+      addComment(node, p.tok.literal)
     else:
       parMessage(p, errInternal, "skipComment")
     getTok(p)
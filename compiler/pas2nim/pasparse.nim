@@ -93,7 +93,7 @@ proc skipCom(p: var TParser, n: PNode) =
   while p.tok.xkind == pxComment: 
     if (n != nil): 
       if n.comment == nil: n.comment = p.tok.literal
-      else: add(n.comment, "\n" & p.tok.literal)
+      else: addComment(n, "\n" & p.tok.literal)
     else: 
       parMessage(p, warnCommentXIgnored, p.tok.literal)
     getTok(p)
@@ -191,6 +191,7 @@ proc trackTryStmt(tracked: PEffects, n: PNode) =
   tracked.bottom = tracked.exc.len
 
   let oldState = tracked.init.len
+  let oldFacts = tracked.guards.len
   var inter: TIntersection = @[]
 
   track(tracked, n.sons[0])  
@@ -199,9 +200,13 @@ proc trackTryStmt(tracked: PEffects, n: PNode) =
   
   var branches = 1
   var hasFinally = false
+  # the handlers may run after any part of the body:
+  setLen(tracked.guards, oldFacts)
+  invalidateWrites(tracked.guards, n.sons[0])
   for i in 1 .. < n.len:
     let b = n.sons[i]
     let blen = sonsLen(b)
+    setLen(tracked.guards, oldFacts)
     if b.kind == nkExceptBranch:
       inc branches
       if blen == 1:
@@ -222,6 +227,7 @@ proc trackTryStmt(tracked: PEffects, n: PNode) =
       hasFinally = true
       
   tracked.bottom = oldBottom
+  setLen(tracked.guards, oldFacts)
   if not hasFinally:
     setLen(tracked.init, oldState)
   for id, count in items(inter):
@@ -335,6 +341,25 @@ proc trackOperand(tracked: PEffects, n: PNode, paramType: PType) =
       mergeTags(tracked, effectList.sons[tagEffects], n)
   notNilCheck(tracked, n, paramType)
 
+proc leavesProc(n: PNode): bool =
+  case n.kind
+  of nkStmtList, nkStmtListExpr:
+    for c in n: 
+      if leavesProc(c): return true
+  of nkReturnStmt, nkRaiseStmt:
+    return true
+  of nkCallKinds:
+    if n.sons[0].kind == nkSym and sfNoReturn in n.sons[0].sym.flags:
+      return true
+  else:
+    discard
+
+proc addCondFact(tracked: PEffects, cond: PNode, negated = false) =
+  if negated: addFactNeg(tracked.guards, cond)
+  else: addFact(tracked.guards, cond)
+  # the condition's own side effects may invalidate what it tested:
+  invalidateWrites(tracked.guards, cond)
+
 proc breaksBlock(n: PNode): bool =
   case n.kind
   of nkStmtList, nkStmtListExpr:
@@ -382,7 +407,7 @@ proc trackCase(tracked: PEffects, n: PNode) =
 proc trackIf(tracked: PEffects, n: PNode) =
   track(tracked, n.sons[0].sons[0])
   let oldFacts = tracked.guards.len
-  addFact(tracked.guards, n.sons[0].sons[0])
+  addCondFact(tracked, n.sons[0].sons[0])
   let oldState = tracked.init.len
 
   var inter: TIntersection = @[]
@@ -396,9 +421,9 @@ proc trackIf(tracked: PEffects, n: PNode) =
     let branch = n.sons[i]
     setLen(tracked.guards, oldFacts)
     for j in 0..i-1:
-      addFactNeg(tracked.guards, n.sons[j].sons[0])
+      addCondFact(tracked, n.sons[j].sons[0], negated=true)
     if branch.len > 1:
-      addFact(tracked.guards, branch.sons[0])
+      addCondFact(tracked, branch.sons[0])
     setLen(tracked.init, oldState)
     for i in 0 .. <branch.len:
       track(tracked, branch.sons[i])
@@ -411,6 +436,9 @@ proc trackIf(tracked: PEffects, n: PNode) =
       if count >= toCover: tracked.init.add id
     # else we can't merge as it is not exhaustive
   setLen(tracked.guards, oldFacts)
+  if n.kind == nkIfStmt and n.len == 1 and leavesProc(n.sons[0].sons[1]):
+    # 'if i >= a.len: return' --> 'i < a.len' holds for the rest of the block
+    addCondFact(tracked, n.sons[0].sons[0], negated=true)
   
 proc trackBlock(tracked: PEffects, n: PNode) =
   if n.kind in {nkStmtList, nkStmtListExpr}:
@@ -435,6 +463,38 @@ proc isTrue(n: PNode): bool =
 proc paramType(op: PType, i: int): PType =
   if op != nil and i < op.len: result = op.sons[i]
 
+proc isStableLocal(tracked: PEffects, n: PNode): bool =
+  # a local that can only be changed by the statements of the tracked proc
+  if n.kind == nkSym and n.sym.owner == tracked.owner:
+    let s = n.sym
+    case s.kind
+    of skLet, skForVar, skTemp: result = true
+    of skVar, skResult: result = {sfGlobal, sfAddrTaken} * s.flags == {}
+    of skParam: result = skipTypes(s.typ, abstractInst).kind != tyVar
+    else: result = false
+
+proc checkIndex(tracked: PEffects, n: PNode) =
+  if nfInBounds in n.flags: return
+  var arr = n.sons[0]
+  let idx = n.sons[1].skipConv
+  var proven = false
+  if idx.kind in {nkCharLit..nkUInt64Lit} or isStableLocal(tracked, idx):
+    case skipTypes(arr.typ, abstractVar).kind
+    of tyArray, tyArrayConstr, tyOpenArray, tyVarargs:
+      # the length cannot change at all:
+      proven = impliesInBounds(tracked.guards, arr, idx)
+    of tySequence, tyString:
+      # the length of a local seq or string only changes by means that
+      # invalidate the facts about it:
+      if arr.kind == nkHiddenDeref: arr = arr.sons[0]
+      if isStableLocal(tracked, arr) and skipTypes(arr.typ,
+          abstractInst).kind in {tySequence, tyString}:
+        proven = impliesInBounds(tracked.guards, arr, idx)
+    else: return
+  if proven: incl(n.flags, nfInBounds)
+  elif warnProveIndex in gNotes:
+    Message(n.info, warnProveIndex, renderTree(n.sons[1]))
+
 proc track(tracked: PEffects, n: PNode) =
   case n.kind
   of nkSym:
@@ -472,6 +532,11 @@ proc track(tracked: PEffects, n: PNode) =
       initVarViaNew(tracked, n.sons[1])
     for i in 0 .. <safeLen(n):
       track(tracked, n.sons[i])
+    invalidateCall(tracked.guards, n)
+  of nkBracketExpr:
+    for i in 0 .. <safeLen(n):
+      track(tracked, n.sons[i])
+    if n.len == 2: checkIndex(tracked, n)
   of nkCheckedFieldExpr:
     track(tracked, n.sons[0])
     if warnProveField in gNotes: checkFieldAccess(tracked.guards, n)
@@ -498,8 +563,17 @@ proc track(tracked: PEffects, n: PNode) =
       # inference for (a, b) and thus no nil checking is necessary.
   of nkCaseStmt: trackCase(tracked, n)
   of nkIfStmt, nkIfExpr: trackIf(tracked, n)
-  of nkBlockStmt, nkBlockExpr: trackBlock(tracked, n.sons[1])
+  of nkBlockStmt, nkBlockExpr:
+    let oldFacts = tracked.guards.len
+    trackBlock(tracked, n.sons[1])
+    if hasSubnodeWith(n.sons[1], nkBreakStmt):
+      # the rest of the block may have been skipped:
+      setLen(tracked.guards, oldFacts)
+      invalidateWrites(tracked.guards, n.sons[1])
   of nkWhileStmt:
+    # the facts must hold for every iteration:
+    invalidateWrites(tracked.guards, n)
+    let oldFacts = tracked.guards.len
     track(tracked, n.sons[0])
     # 'while true' loop?
     if isTrue(n.sons[0]):
@@ -507,17 +581,19 @@ proc track(tracked: PEffects, n: PNode) =
     else:
       # loop may never execute:
       let oldState = tracked.init.len
-      let oldFacts = tracked.guards.len
-      addFact(tracked.guards, n.sons[0])
+      addCondFact(tracked, n.sons[0])
       track(tracked, n.sons[1])
       setLen(tracked.init, oldState)
-      setLen(tracked.guards, oldFacts)
+    setLen(tracked.guards, oldFacts)
   of nkForStmt, nkParForStmt:
     # we are very conservative here and assume the loop is never executed:
+    invalidateWrites(tracked.guards, n)
     let oldState = tracked.init.len
+    let oldFacts = tracked.guards.len
     for i in 0 .. <len(n):
       track(tracked, n.sons[i])
     setLen(tracked.init, oldState)
+    setLen(tracked.guards, oldFacts)
   of nkObjConstr:
     track(tracked, n.sons[0])
     let oldFacts = tracked.guards.len
@@ -742,7 +742,12 @@ proc semProcTypeNode(c: PContext, n, genericParams: PNode,
       
     if skipTypes(typ, {tyGenericInst}).kind == tyEmpty: continue
     for j in countup(0, length-3): 
-      var arg = newSymG(skParam, a.sons[j], c)
+      var arg: PSym
+      if a.sons[j].kind == nkPragmaExpr:
+        arg = newSymG(skParam, a.sons[j].sons[0], c)
+        pragma(c, arg, a.sons[j].sons[1], paramPragmas)
+      else:
+        arg = newSymG(skParam, a.sons[j], c)
       let lifted = liftParamType(c, kind, genericParams, typ,
                                  arg.name.s, arg.info)
       let finalType = if lifted != nil: lifted else: typ.skipIntLit
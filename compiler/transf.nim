@@ -20,7 +20,7 @@
 import 
   intsets, strutils, lists, options, ast, astalgo, trees, treetab, msgs, os, 
   idents, renderer, types, passes, semfold, magicsys, cgmeth, rodread,
-  lambdalifting, sempass2
+  lambdalifting, sempass2, escapes, moves
 
 const 
   genPrefix* = ":tmp"         # prefix for generated names
@@ -426,10 +426,113 @@ proc findWrongOwners(c: PTransf, n: PNode) =
   else:
     for i in 0 .. <safeLen(n): findWrongOwners(c, n.sons[i])
   
+proc baseSym(n: PNode): PSym =
+  # the local or parameter 'x' of the location expressions 'x' and 'x[]'
+  var n = n
+  if n.kind == nkHiddenDeref: n = n.sons[0]
+  if n.kind == nkSym and n.sym.kind in {skVar, skLet, skParam, skForVar}:
+    result = n.sym
+
+proc lengthBound(n: PNode): PSym =
+  # returns the 'x' of 'high(x)' or 'len(x)-1' for a seq, string or openarray
+  var x: PNode
+  case getMagic(n)
+  of mHigh:
+    x = n.sons[1]
+  of mSubI, mSubI64:
+    let one = skipConv(n.sons[2])
+    if one.kind in {nkCharLit..nkUInt64Lit} and one.intVal == 1 and
+        getMagic(n.sons[1]) in {mLengthSeq, mLengthStr, mLengthOpenArray}:
+      x = n.sons[1].sons[1]
+  else: nil
+  if x != nil and skipTypes(x.typ, abstractVar).kind in {tySequence, tyString,
+      tyOpenArray, tyVarargs}:
+    result = baseSym(x)
+
+proc isLengthType(t: PType): bool =
+  result = t.kind in {tySequence, tyString, tyOpenArray, tyVarargs}
+
+proc passesLengthByVar(n: PNode): bool =
+  # a 'var' parameter may change the length of its argument; this is checked
+  # on the argument since the formal type may be a generic 'var T'
+  let t = n.sons[0].typ
+  if t == nil or t.kind != tyProc: return true
+  for i in countup(1, min(sonsLen(n), sonsLen(t)) - 1):
+    if t.sons[i].kind == tyVar and n.sons[i].typ != nil and
+        searchTypeFor(skipTypes(n.sons[i].typ, {tyVar}), isLengthType):
+      return true
+
+proc isMutableReach(t: PType): bool =
+  result = t.kind in {tyRef, tyPtr, tyPointer, tyVar, tySequence, tyString,
+                      tyOpenArray, tyVarargs}
+
+proc passesMutableReach(n: PNode): bool =
+  # 'noSideEffect' still allows writes through 'ref' and 'ptr' parameters,
+  # and seqs, strings and openarrays share their buffer with the caller
+  for i in countup(1, sonsLen(n) - 1):
+    if n.sons[i].typ == nil or searchTypeFor(n.sons[i].typ, isMutableReach):
+      return true
+
+proc changesLengths(n: PNode): bool =
+  # conservatively checks whether 'n' may change the length of any seq,
+  # string or openarray
+  case n.kind
+  of nkEmpty..nkNilLit, nkTypeSection, nkConstSection, nkPragma, nkProcDef,
+     nkMethodDef, nkConverterDef, nkMacroDef, nkTemplateDef, nkIteratorDef:
+    result = false
+  of nkAddr, nkYieldStmt:
+    # a 'yield' runs the caller's loop body which may change anything
+    result = true
+  of nkAsgn, nkFastAsgn, nkHiddenAddr:
+    result = containsGarbageCollectedRef(n.sons[0].typ)
+  of nkCallKinds:
+    let op = n.sons[0]
+    if passesLengthByVar(n): 
+      result = true
+    elif op.kind == nkSym and op.sym.magic != mNone:
+      result = false
+    else:
+      result = not (op.kind == nkSym and sfNoSideEffect in op.sym.flags or
+          op.typ != nil and tfNoSideEffect in op.typ.flags) or
+          passesMutableReach(n)
+  else:
+    result = false
+  if not result:
+    for i in 0 .. <safeLen(n):
+      if changesLengths(n.sons[i]): return true
+
+proc markInBounds(n: PNode, i, x: PSym) =
+  case n.kind
+  of nkEmpty..nkNilLit: nil
+  of nkBracketExpr:
+    let idx = skipConv(n.sons[1])
+    if idx.kind == nkSym and idx.sym == i and baseSym(n.sons[0]) == x:
+      incl(n.flags, nfInBounds)
+    for j in 0 .. <n.len: markInBounds(n.sons[j], i, x)
+  else:
+    for j in 0 .. <n.len: markInBounds(n.sons[j], i, x)
+
+proc markLoopBounds(n: PNode) =
+  # for i in 0..high(x): x[i] needs no index check if the body cannot change
+  # the length of 'x'; then the loop is also friendlier to the vectorizer.
+  if n.len != 3: return
+  let call = n.sons[1]
+  if call.kind notin nkCallKinds or call.len < 3 or
+      call.sons[0].kind != nkSym: return
+  let iter = call.sons[0].sym
+  if iter.name.s notin ["countup", ".."] or
+      sfSystemModule notin getModule(iter).flags: return
+  let lo = skipConv(call.sons[1])
+  if lo.kind notin {nkCharLit..nkUInt64Lit} or lo.intVal < 0: return
+  let x = lengthBound(skipConv(call.sons[2]))
+  if x != nil and n.sons[0].kind == nkSym and not changesLengths(n.sons[2]):
+    markInBounds(n.sons[2], n.sons[0].sym, x)
+
 proc transformFor(c: PTransf, n: PNode): PTransNode = 
   # generate access statements for the parameters (unless they are constant)
   # put mapping from formal parameters to actual parameters
   if n.kind != nkForStmt: InternalError(n.info, "transformFor")
+  markLoopBounds(n)
 
   var length = sonsLen(n)
   var call = n.sons[length - 2]
@@ -745,6 +848,8 @@ proc transformBody*(module: PSym, n: PNode, prc: PSym): PNode =
       result = lambdalifting.liftIterator(prc, result)
     incl(result.flags, nfTransf)
     when useEffectSystem: trackProc(prc, result)
+    if optStackAlloc in gGlobalOptions: markStackAllocs(prc, result)
+    markMoves(prc, result)
 
 proc transformStmt*(module: PSym, n: PNode): PNode =
   if nfTransf in n.flags:
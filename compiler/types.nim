@@ -244,7 +244,7 @@ proc searchTypeForAux(t: PType, predicate: TTypePredicate,
   else: 
     nil
 
-proc searchTypeFor(t: PType, predicate: TTypePredicate): bool = 
+proc searchTypeFor*(t: PType, predicate: TTypePredicate): bool = 
   var marker = InitIntSet()
   result = searchTypeForAux(t, predicate, marker)
 
@@ -320,6 +320,39 @@ static unsigned long nimNaN[2]={0xffffffff, 0x7fffffff};
 #endif
 
 typedef struct TFrame TFrame;
+#ifdef NIM_STATIC_FRAMES
+/* every proc owns a read-only descriptor; the frame only stores a pointer
+   to it and the index of the location that is currently executing */
+typedef struct {
+  NCSTRING filename;
+  NI line;
+} TLineEntry;
+
+typedef struct {
+  NCSTRING procname;
+  NCSTRING filename;
+  const TLineEntry* locs;
+} TFrameDesc;
+
+struct TFrame {
+  TFrame* prev;
+  const TFrameDesc* desc;
+  NI loc;
+};
+
+#define nimfrd(fd) \
+  TFrame F; \
+  F.desc = &fd; F.loc = 0; nimFrame(&F);
+
+#define nimloc(id) \
+  F.loc = id;
+
+#define nimFrameProcname(f) ((f)->desc->procname)
+#define nimFrameFilename(f) \
+  ((f)->loc == 0 ? (f)->desc->filename : (f)->desc->locs[(f)->loc-1].filename)
+#define nimFrameLine(f) \
+  ((f)->loc == 0 ? 0 : (f)->desc->locs[(f)->loc-1].line)
+#else
 struct TFrame {
   TFrame* prev;
   NCSTRING procname;
@@ -327,6 +360,7 @@ struct TFrame {
   NCSTRING filename;
   NI len;
 };
+#endif
 
 #define nimfr(proc, file) \
   TFrame F; \
@@ -373,5 +407,26 @@ static inline void GCGuard (void *ptr) { asm volatile ("" :: "X" (ptr)); }
 #  define GC_GUARD
 #endif
 
+/* vector types of the simd module: GCC and clang keep them in vector
+   registers; other C compilers only see the array. The vector member only
+   requires the alignment of its lanes as the heap does not guarantee more,
+   so GCC has to use unaligned loads and stores for it. */
+#if defined(__GNUC__) || defined(__clang__)
+#  define NIM_VECTOR(name, base, n) \
+     typedef base name##_v __attribute__((vector_size(sizeof(base)*(n)), \
+                                          aligned(sizeof(base)))); \
+     typedef union { base data[n]; name##_v v; } name
+#else
+#  define NIM_VECTOR(name, base, n) typedef struct { base data[n]; } name
+#endif
+NIM_VECTOR(NF32x4, NF32, 4);
+NIM_VECTOR(NF32x8, NF32, 8);
+NIM_VECTOR(NF64x2, NF64, 2);
+NIM_VECTOR(NF64x4, NF64, 4);
+NIM_VECTOR(NI32x4, NI32, 4);
+NIM_VECTOR(NI32x8, NI32, 8);
+NIM_VECTOR(NI64x2, NI64, 2);
+NIM_VECTOR(NI64x4, NI64, 4);
+
 typedef int assert_numbits[sizeof(NI) == sizeof(void*) && NIM_INTBITS == sizeof(NI)*8 ? 1 : -1];
 #endif
@@ -10,6 +10,7 @@
 import math
 import strutils
 import times
+import simd
 
 
 ## Basic 3d support with vectors, points, matrices and some basic utilities.
@@ -160,26 +161,23 @@ proc matrix3d*(ax,ay,az,aw,bx,by,bz,bw,cx,cy,cz,cw,tx,ty,tz,tw:float):TMatrix3d
 
 proc `&`*(a,b:TMatrix3d):TMatrix3d {.noinit.} =
   ## Concatenates matrices returning a new matrix.
+  # every row of the result is a combination of the rows of `b`, so the
+  # rows are computed with 4 lanes at once; the order of the additions is
+  # the same as in the scalar formula.
+  let
+    b0=vec4f64(b.ax,b.ay,b.az,b.aw)
+    b1=vec4f64(b.bx,b.by,b.bz,b.bw)
+    b2=vec4f64(b.cx,b.cy,b.cz,b.cw)
+    b3=vec4f64(b.tx,b.ty,b.tz,b.tw)
+    r0=a.aw*b3+a.az*b2+a.ay*b1+a.ax*b0
+    r1=a.bw*b3+a.bz*b2+a.by*b1+a.bx*b0
+    r2=a.cw*b3+a.cz*b2+a.cy*b1+a.cx*b0
+    r3=a.tw*b3+a.tz*b2+a.ty*b1+a.tx*b0
   result.setElements(
-    a.aw*b.tx+a.az*b.cx+a.ay*b.bx+a.ax*b.ax,
-    a.aw*b.ty+a.az*b.cy+a.ay*b.by+a.ax*b.ay,
-    a.aw*b.tz+a.az*b.cz+a.ay*b.bz+a.ax*b.az,
-    a.aw*b.tw+a.az*b.cw+a.ay*b.bw+a.ax*b.aw,
-
-    a.bw*b.tx+a.bz*b.cx+a.by*b.bx+a.bx*b.ax,
-    a.bw*b.ty+a.bz*b.cy+a.by*b.by+a.bx*b.ay,
-    a.bw*b.tz+a.bz*b.cz+a.by*b.bz+a.bx*b.az,
-    a.bw*b.tw+a.bz*b.cw+a.by*b.bw+a.bx*b.aw,
-
-    a.cw*b.tx+a.cz*b.cx+a.cy*b.bx+a.cx*b.ax,
-    a.cw*b.ty+a.cz*b.cy+a.cy*b.by+a.cx*b.ay,
-    a.cw*b.tz+a.cz*b.cz+a.cy*b.bz+a.cx*b.az,
-    a.cw*b.tw+a.cz*b.cw+a.cy*b.bw+a.cx*b.aw,
-
-    a.tw*b.tx+a.tz*b.cx+a.ty*b.bx+a.tx*b.ax,
-    a.tw*b.ty+a.tz*b.cy+a.ty*b.by+a.tx*b.ay,
-    a.tw*b.tz+a.tz*b.cz+a.ty*b.bz+a.tx*b.az,
-    a.tw*b.tw+a.tz*b.cw+a.ty*b.bw+a.tx*b.aw)
+    r0[0],r0[1],r0[2],r0[3],
+    r1[0],r1[1],r1[2],r1[3],
+    r2[0],r2[1],r2[2],r2[3],
+    r3[0],r3[1],r3[2],r3[3])
 
 
 proc scale*(s:float):TMatrix3d {.noInit.} =
@@ -759,10 +759,10 @@ proc toPretty(result: var string, node: PJsonNode, indent = 2, ml = True,
     result.add(escapeJson(node.str))
   of JInt:
     if lstArr: result.indent(currIndent)
-    result.add($node.num)
+    result.addInt(node.num)
   of JFloat:
     if lstArr: result.indent(currIndent)
-    result.add($node.fnum)
+    result.addFloat(node.fnum)
   of JBool:
     if lstArr: result.indent(currIndent)
     result.add($node.bval)
@@ -21,7 +21,32 @@ else:
 
 import os
 
+when defined(linux):
+  var
+    MAP_POPULATE {.importc, header: "<sys/mman.h>".}: cint
+    MADV_HUGEPAGE {.importc, header: "<sys/mman.h>".}: cint
+  proc madvise(a1: pointer, a2: int, a3: cint): cint {.
+    importc, header: "<sys/mman.h>".}
+
+proc c_memchr(s: pointer, c: char, n: csize): pointer {.
+  importc: "memchr", header: "<string.h>".}
+
 type
+  TMapFlag* = enum   ## flags for `open`
+    mfPopulate,      ## read the whole mapping in advance (Linux only)
+    mfHugePages      ## prefer huge pages for the mapping; this is only a 
+                     ## hint (Linux only)
+
+  TMemAdvice* = enum ## the expected access pattern; see `advise`
+    maNormal,        ## no special treatment
+    maSequential,    ## the pages are accessed in order; read ahead
+                     ## aggressively and drop the pages after use
+    maRandom,        ## the pages are accessed randomly; do not read ahead
+    maWillNeed,      ## the pages will be needed soon; read them now
+    maDontNeed       ## the pages will not be needed soon
+
+  TMemSlice* = tuple[data: pointer, size: int] ## a part of a mapping
+
   TMemFile* = object {.pure.} ## represents a memory mapped file
     mem*: pointer    ## a pointer to the memory mapped file. The pointer
                      ## can be used directly to change the contents of the
@@ -34,12 +59,29 @@ type
     else:
       handle: cint
 
+proc advise*(f: TMemFile, advice: TMemAdvice, offset = 0, size = -1) =
+  ## tells the operating system how the mapping (or the `size` bytes of it
+  ## starting at `offset`) will be accessed. `offset` has to be a multiple
+  ## of the page size. This is only a hint and does nothing on Windows.
+  when defined(posix):
+    var a: cint
+    case advice
+    of maNormal: a = POSIX_MADV_NORMAL
+    of maSequential: a = POSIX_MADV_SEQUENTIAL
+    of maRandom: a = POSIX_MADV_RANDOM
+    of maWillNeed: a = POSIX_MADV_WILLNEED
+    of maDontNeed: a = POSIX_MADV_DONTNEED
+    var len = if size == -1: f.size - offset else: size
+    discard posix_madvise(cast[pointer](cast[TAddress](f.mem) +% offset), 
+                          len, a)
+
 proc open*(filename: string, mode: TFileMode = fmRead,
-           mappedSize = -1, offset = 0, newFileSize = -1): TMemFile =
+           mappedSize = -1, offset = 0, newFileSize = -1,
+           flags: set[TMapFlag] = {}): TMemFile =
   ## opens a memory mapped file. If this fails, ``EOS`` is raised.
   ## `newFileSize` can only be set if the file is not opened with ``fmRead``
   ## access. `mappedSize` and `offset` can be used to map only a slice of
-  ## the file.
+  ## the file; use `mapMem` to map further slices of it.
 
   # The file can be resized only when write mode is used:
   assert newFileSize == -1 or mode != fmRead
@@ -150,17 +192,66 @@ proc open*(filename: string, mode: TFileMode = fmRead,
       else:
         fail(OSLastError(), "error getting file size")
 
+    var mapFlags = if readonly: MAP_PRIVATE else: MAP_SHARED
+    when defined(linux):
+      if mfPopulate in flags: mapFlags = mapFlags or MAP_POPULATE
+
     result.mem = mmap(
       nil,
       result.size,
       if readonly: PROT_READ else: PROT_READ or PROT_WRITE,
-      if readonly: MAP_PRIVATE else: MAP_SHARED,
+      mapFlags,
       result.handle,
       offset)
 
     if result.mem == cast[pointer](MAP_FAILED):
       fail(OSLastError(), "file mapping failed")
 
+    when defined(linux):
+      if mfHugePages in flags:
+        discard madvise(result.mem, result.size, MADV_HUGEPAGE)
+
+proc mapMem*(m: var TMemFile, mode: TFileMode = fmRead,
+             mappedSize = -1, offset = 0): pointer =
+  ## maps another slice of the file `m` refers to; together with `unmapMem`
+  ## this allows to slide a window over files that are bigger than the
+  ## address space that should be used for them. `offset` has to be a
+  ## multiple of the page size (of the allocation granularity on Windows).
+  ## `mappedSize` can only be -1 on Windows, where it means "up to the end of
+  ## the file". If this fails, ``EOS`` is raised.
+  var readonly = mode == fmRead
+  when defined(windows):
+    result = MapViewOfFileEx(
+      m.mapHandle,
+      if readonly: FILE_MAP_READ else: FILE_MAP_WRITE,
+      int32(offset shr 32),
+      int32(offset and 0xffffffff),
+      if mappedSize == -1: 0 else: mappedSize,
+      nil)
+    if result == nil:
+      OSError(OSLastError())
+  else:
+    assert mappedSize > 0
+    result = mmap(
+      nil,
+      mappedSize,
+      if readonly: PROT_READ else: PROT_READ or PROT_WRITE,
+      if readonly: MAP_PRIVATE else: MAP_SHARED,
+      m.handle,
+      offset)
+    if result == cast[pointer](MAP_FAILED):
+      OSError(OSLastError())
+
+proc unmapMem*(f: var TMemFile, p: pointer, size: int) =
+  ## unmaps the slice `p` that was mapped by `mapMem`. `size` has to be the
+  ## `mappedSize` that was passed to `mapMem`. If this fails, ``EOS`` is
+  ## raised. Changes are written back to the file if the slice was mapped
+  ## with write access.
+  when defined(windows):
+    if UnmapViewOfFile(p) == 0: OSError(OSLastError())
+  else:
+    if munmap(p, size) != 0: OSError(OSLastError())
+
 proc close*(f: var TMemFile) =
   ## closes the memory mapped file `f`. All changes are written back to the
   ## file system, if `f` was opened with write access.
@@ -191,3 +282,41 @@ proc close*(f: var TMemFile) =
   
   if error: OSError(lastErr)
 
+proc `$`*(ms: TMemSlice): string {.inline.} =
+  ## copies the slice `ms` into a new string.
+  result = newString(ms.size)
+  if ms.size > 0: copyMem(addr(result[0]), ms.data, ms.size)
+
+iterator lines*(mfile: TMemFile, delim = '\l', eat = '\r'): TMemSlice {.
+    inline.} =
+  ## iterates over the lines of `mfile` without copying them: every line is
+  ## a pointer into the mapping and its length. Neither the `delim` that
+  ## ends a line nor an `eat` character just before it are part of the
+  ## line; ``eat = '\0'`` keeps it. A final line without `delim` is
+  ## returned too. Use ``$`` to turn a line into a string and
+  ## ``advise(mfile, maSequential)`` for faster reading.
+  ##
+  ## .. code-block:: nimrod
+  ##   var f = memfiles.open("big.txt")
+  ##   var count = 0
+  ##   for line in lines(f):
+  ##     if line.size == 0: inc(count)
+  ##   echo "empty lines: ", count
+  ##   f.close()
+  var ms: TMemSlice
+  var ending = cast[TAddress](mfile.mem) +% mfile.size
+  ms.data = mfile.mem
+  var remaining = mfile.size
+  while remaining > 0:
+    var p = c_memchr(ms.data, delim, remaining)
+    if p == nil:
+      ms.size = remaining
+      yield ms
+      break
+    ms.size = cast[TAddress](p) -% cast[TAddress](ms.data)
+    if eat != '\0' and ms.size > 0 and 
+        cast[cstring](ms.data)[ms.size-1] == eat:
+      dec(ms.size)
+    yield ms
+    ms.data = cast[pointer](cast[TAddress](p) +% 1)
+    remaining = ending -% cast[TAddress](ms.data)
@@ -0,0 +1,252 @@
+#
+#
+#            Nimrod's Runtime Library
+#        (c) Copyright 2013 Andreas Rumpf
+#
+#    See the file "copying.txt", included in this
+#    distribution, for details about the copyright.
+#
+
+## This module implements fixed width vector types with lanewise arithmetic,
+## compare and select, shuffles, loads and stores and horizontal reductions.
+##
+## For the C backend the types map to GCC vector extensions (see
+## ``NIM_VECTOR`` in ``nimbase.h``), so they are kept in vector registers.
+## They only require the alignment of their lanes, so they can be stored in
+## seqs and on the heap. The operations are written as loops over the lanes
+## with a constant trip count which GCC's vectorizer turns into single vector
+## instructions in release builds. The very same code runs unchanged on the
+## JS backend and in the compile time evaluator. Integer lanes wrap around
+## on overflow.
+##
+## .. code-block:: nimrod
+##   var a = vec4f32(1.0, 2.0, 3.0, 4.0)
+##   var b = splat4f32(2.0)
+##   echo sum(a * b + a)            # 30.0
+##   echo select(cmpLt(a, b), a, b) # [1.0, 2.0, 2.0, 2.0]
+
+{.push overflowChecks: off, line_dir: off, stack_trace: off.}
+
+when defined(JS) or defined(NimrodVM):
+  type
+    TVec4f32* {.final.} = object ## 4 lanes of ``float32``
+      data: array[0..3, float32]
+    TVec8f32* {.final.} = object ## 8 lanes of ``float32``
+      data: array[0..7, float32]
+    TVec2f64* {.final.} = object ## 2 lanes of ``float64``
+      data: array[0..1, float64]
+    TVec4f64* {.final.} = object ## 4 lanes of ``float64``
+      data: array[0..3, float64]
+    TVec4i32* {.final.} = object ## 4 lanes of ``int32``
+      data: array[0..3, int32]
+    TVec8i32* {.final.} = object ## 8 lanes of ``int32``
+      data: array[0..7, int32]
+    TVec2i64* {.final.} = object ## 2 lanes of ``int64``
+      data: array[0..1, int64]
+    TVec4i64* {.final.} = object ## 4 lanes of ``int64``
+      data: array[0..3, int64]
+else:
+  type
+    TVec4f32* {.importc: "NF32x4", nodecl, final.} = object
+      data: array[0..3, float32]
+    TVec8f32* {.importc: "NF32x8", nodecl, final.} = object
+      data: array[0..7, float32]
+    TVec2f64* {.importc: "NF64x2", nodecl, final.} = object
+      data: array[0..1, float64]
+    TVec4f64* {.importc: "NF64x4", nodecl, final.} = object
+      data: array[0..3, float64]
+    TVec4i32* {.importc: "NI32x4", nodecl, final.} = object
+      data: array[0..3, int32]
+    TVec8i32* {.importc: "NI32x8", nodecl, final.} = object
+      data: array[0..7, int32]
+    TVec2i64* {.importc: "NI64x2", nodecl, final.} = object
+      data: array[0..1, int64]
+    TVec4i64* {.importc: "NI64x4", nodecl, final.} = object
+      data: array[0..3, int64]
+
+template vectorOps(V, T, M: expr, n: int, splatName: expr) {.immediate.} =
+  proc `[]`*(v: V, i: int): T {.inline.} = v.data[i]
+  proc `[]=`*(v: var V, i: int, x: T) {.inline.} = v.data[i] = x
+
+  proc shuffle*(a: V, idx: array[0..n-1, int]): V {.inline.} =
+    ## lane ``i`` of the result is lane ``idx[i]`` of `a`.
+    for i in 0 .. n-1: result.data[i] = a.data[idx[i]]
+
+  proc load*(v: var V, a: openarray[T], start = 0) {.inline.} =
+    ## loads ``a[start .. start+lanes-1]`` into `v`.
+    for i in 0 .. n-1: v.data[i] = a[start+i]
+  proc store*(v: V, a: var openarray[T], start = 0) {.inline.} =
+    ## stores `v` into ``a[start .. start+lanes-1]``.
+    for i in 0 .. n-1: a[start+i] = v.data[i]
+
+  proc `$`*(v: V): string =
+    result = "["
+    for i in 0 .. n-1:
+      if i > 0: result.add(", ")
+      result.add($v.data[i])
+    result.add("]")
+
+  # the lane index of the following loops is always in range:
+  {.push boundChecks: off.}
+  proc splatName*(x: T): V {.inline.} =
+    ## returns a vector with all lanes set to `x`.
+    for i in 0 .. n-1: result.data[i] = x
+
+  proc `+`*(a, b: V): V {.inline.} =
+    for i in 0 .. n-1: result.data[i] = a.data[i] + b.data[i]
+  proc `-`*(a, b: V): V {.inline.} =
+    for i in 0 .. n-1: result.data[i] = a.data[i] - b.data[i]
+  proc `*`*(a, b: V): V {.inline.} =
+    for i in 0 .. n-1: result.data[i] = a.data[i] * b.data[i]
+  proc `-`*(a: V): V {.inline.} =
+    for i in 0 .. n-1: result.data[i] = -a.data[i]
+
+  proc `*`*(a: T, b: V): V {.inline.} =
+    for i in 0 .. n-1: result.data[i] = a * b.data[i]
+  proc `*`*(a: V, b: T): V {.inline.} =
+    for i in 0 .. n-1: result.data[i] = a.data[i] * b
+
+  proc `+=`*(a: var V, b: V) {.inline.} =
+    for i in 0 .. n-1: a.data[i] = a.data[i] + b.data[i]
+  proc `-=`*(a: var V, b: V) {.inline.} =
+    for i in 0 .. n-1: a.data[i] = a.data[i] - b.data[i]
+  proc `*=`*(a: var V, b: V) {.inline.} =
+    for i in 0 .. n-1: a.data[i] = a.data[i] * b.data[i]
+
+  proc min*(a, b: V): V {.inline.} =
+    ## lanewise minimum.
+    for i in 0 .. n-1:
+      result.data[i] = if a.data[i] <= b.data[i]: a.data[i] else: b.data[i]
+  proc max*(a, b: V): V {.inline.} =
+    ## lanewise maximum.
+    for i in 0 .. n-1:
+      result.data[i] = if a.data[i] >= b.data[i]: a.data[i] else: b.data[i]
+
+  proc `==`*(a, b: V): bool =
+    for i in 0 .. n-1:
+      if a.data[i] != b.data[i]: return false
+    result = true
+
+  proc cmpEq*(a, b: V): M {.inline.} =
+    ## lanewise ``==``; a lane of the resulting mask is -1 if the comparison
+    ## holds and 0 otherwise.
+    for i in 0 .. n-1:
+      if a.data[i] == b.data[i]: result.data[i] = -1
+  proc cmpLt*(a, b: V): M {.inline.} =
+    ## lanewise ``<``.
+    for i in 0 .. n-1:
+      if a.data[i] < b.data[i]: result.data[i] = -1
+  proc cmpLe*(a, b: V): M {.inline.} =
+    ## lanewise ``<=``.
+    for i in 0 .. n-1:
+      if a.data[i] <= b.data[i]: result.data[i] = -1
+
+  proc select*(m: M, a, b: V): V {.inline.} =
+    ## takes a lane of `a` where the mask `m` is set and of `b` otherwise.
+    for i in 0 .. n-1:
+      result.data[i] = if m.data[i] != 0: a.data[i] else: b.data[i]
+
+  proc sum*(v: V): T {.inline.} =
+    ## adds all lanes of `v`.
+    result = v.data[0]
+    for i in 1 .. n-1: result = result + v.data[i]
+  proc min*(v: V): T {.inline.} =
+    ## the smallest lane of `v`.
+    result = v.data[0]
+    for i in 1 .. n-1:
+      if v.data[i] < result: result = v.data[i]
+  proc max*(v: V): T {.inline.} =
+    ## the biggest lane of `v`.
+    result = v.data[0]
+    for i in 1 .. n-1:
+      if v.data[i] > result: result = v.data[i]
+  {.pop.}
+
+template floatOps(V: expr, n: int) {.immediate.} =
+  {.push boundChecks: off.}
+  proc `/`*(a, b: V): V {.inline.} =
+    for i in 0 .. n-1: result.data[i] = a.data[i] / b.data[i]
+  {.pop.}
+
+template intOps(V: expr, n: int) {.immediate.} =
+  {.push boundChecks: off.}
+  proc `and`*(a, b: V): V {.inline.} =
+    for i in 0 .. n-1: result.data[i] = a.data[i] and b.data[i]
+  proc `or`*(a, b: V): V {.inline.} =
+    for i in 0 .. n-1: result.data[i] = a.data[i] or b.data[i]
+  proc `xor`*(a, b: V): V {.inline.} =
+    for i in 0 .. n-1: result.data[i] = a.data[i] xor b.data[i]
+  {.pop.}
+
+vectorOps(TVec4f32, float32, TVec4i32, 4, splat4f32)
+vectorOps(TVec8f32, float32, TVec8i32, 8, splat8f32)
+vectorOps(TVec2f64, float64, TVec2i64, 2, splat2f64)
+vectorOps(TVec4f64, float64, TVec4i64, 4, splat4f64)
+vectorOps(TVec4i32, int32, TVec4i32, 4, splat4i32)
+vectorOps(TVec8i32, int32, TVec8i32, 8, splat8i32)
+vectorOps(TVec2i64, int64, TVec2i64, 2, splat2i64)
+vectorOps(TVec4i64, int64, TVec4i64, 4, splat4i64)
+
+floatOps(TVec4f32, 4)
+floatOps(TVec8f32, 8)
+floatOps(TVec2f64, 2)
+floatOps(TVec4f64, 4)
+
+intOps(TVec4i32, 4)
+intOps(TVec8i32, 8)
+intOps(TVec2i64, 2)
+intOps(TVec4i64, 4)
+
+proc vec4f32*(a, b, c, d: float32): TVec4f32 {.inline.} =
+  result.data[0] = a
+  result.data[1] = b
+  result.data[2] = c
+  result.data[3] = d
+
+proc vec8f32*(a, b, c, d, e, f, g, h: float32): TVec8f32 {.inline.} =
+  result.data[0] = a
+  result.data[1] = b
+  result.data[2] = c
+  result.data[3] = d
+  result.data[4] = e
+  result.data[5] = f
+  result.data[6] = g
+  result.data[7] = h
+
+proc vec2f64*(a, b: float64): TVec2f64 {.inline.} =
+  result.data[0] = a
+  result.data[1] = b
+
+proc vec4f64*(a, b, c, d: float64): TVec4f64 {.inline.} =
+  result.data[0] = a
+  result.data[1] = b
+  result.data[2] = c
+  result.data[3] = d
+
+proc vec4i32*(a, b, c, d: int32): TVec4i32 {.inline.} =
+  result.data[0] = a
+  result.data[1] = b
+  result.data[2] = c
+  result.data[3] = d
+
+proc vec8i32*(a, b, c, d, e, f, g, h: int32): TVec8i32 {.inline.} =
+  result.data[0] = a
+  result.data[1] = b
+  result.data[2] = c
+  result.data[3] = d
+  result.data[4] = e
+  result.data[5] = f
+  result.data[6] = g
+  result.data[7] = h
+
+proc vec2i64*(a, b: int64): TVec2i64 {.inline.} =
+  result.data[0] = a
+  result.data[1] = b
+
+proc vec4i64*(a, b, c, d: int64): TVec4i64 {.inline.} =
+  result.data[0] = a
+  result.data[1] = b
+  result.data[2] = c
+  result.data[3] = d
+
+{.pop.}
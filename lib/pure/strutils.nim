@@ -1109,7 +1109,9 @@ type
   TFloatFormat* = enum ## the different modes of floating point formating
     ffDefault,         ## use the shorter floating point notation
     ffDecimal,         ## use decimal floating point notation
-    ffScientific       ## use scientific notation (using ``e`` character)
+    ffScientific,      ## use scientific notation (using ``e`` character)
+    ffShortest         ## use the shortest notation that reads back as the
+                       ## same value; `precision` is ignored
 
 proc formatBiggestFloat*(f: BiggestFloat, format: TFloatFormat = ffDefault,
                          precision: range[0..32] = 16): string {.
@@ -1124,10 +1126,16 @@ proc formatBiggestFloat*(f: BiggestFloat, format: TFloatFormat = ffDefault,
   ## after the decimal point for Nimrod's ``biggestFloat`` type.
   ## 
   ## If ``precision == 0``, it tries to format it nicely.
-  const floatFormatToChar: array[TFloatFormat, char] = ['g', 'f', 'e']
+  ## ``ffShortest`` ignores `precision` and produces the shortest
+  ## representation that reads back as `f`, like ``addFloat``.
+  const floatFormatToChar: array[TFloatFormat, char] = ['g', 'f', 'e', 'g']
   var
     frmtstr {.noinit.}: array[0..5, char]
     buf {.noinit.}: array[0..2500, char]
+  if format == ffShortest:
+    result = newStringOfCap(24)
+    result.addFloat(f)
+    return
   frmtstr[0] = '%'
   if precision > 0:
     frmtstr[1] = '#'
@@ -1305,6 +1313,8 @@ when isMainModule:
                    it goes""", 10, false)
   doAssert formatBiggestFloat(0.00000000001, ffDecimal, 11) == "0.00000000001"
   doAssert formatBiggestFloat(0.00000000001, ffScientific, 1) == "1.0e-11"
+  doAssert formatFloat(0.1, ffShortest) == "0.1"
+  doAssert formatFloat(-1.5e-7, ffShortest) == "-1.5e-7"
 
   doAssert "$# $3 $# $#" % ["a", "b", "c"] == "a c b c"
   echo formatSize(1'i64 shl 31 + 300'i64) # == "4,GB"
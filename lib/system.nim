@@ -1221,6 +1221,25 @@ proc `$` *(x: float): string {.magic: "FloatToStr", noSideEffect.}
   ## The stingify operator for a float argument. Returns `x`
   ## converted to a decimal string.
 
+when not defined(NimrodVM) and not defined(JS) and hostOS != "standalone":
+  proc addInt*(result: var string, x: int64) {.noSideEffect.}
+    ## appends `x` converted to a decimal string to `result`. This is
+    ## the same as ``result.add($x)`` but needs no temporary string.
+
+  proc addFloat*(result: var string, x: float) {.noSideEffect.}
+    ## appends the shortest decimal representation of `x` that reads
+    ## back as `x` to `result`. The output always contains a ``.`` or an
+    ## exponent, so it reads back as a float: ``1.0``, ``0.1``,
+    ## ``1.5e-7`` and ``1e300``. NaN and infinity are appended as ``nan``,
+    ## ``inf`` and ``-inf``. Note that ``$`` uses a different format.
+else:
+  # the other targets have no allocation free versions:
+  proc addInt*(result: var string, x: int64) {.noSideEffect.} =
+    result.add($x)
+
+  proc addFloat*(result: var string, x: float) {.noSideEffect.} =
+    result.add($x)
+
 proc `$` *(x: bool): string {.magic: "BoolToStr", noSideEffect.}
   ## The stingify operator for a boolean argument. Returns `x`
   ## converted to the string "false" or "true".
@@ -1767,15 +1786,31 @@ var
     ## If the handler does not raise an exception, ordinary control flow
     ## continues and the program is terminated.
 
-type
-  PFrame* = ptr TFrame  ## represents a runtime frame of the call stack;
-                        ## part of the debugger API.
-  TFrame* {.importc, nodecl, final.} = object ## the frame itself
-    prev*: PFrame       ## previous frame; used for chaining the call stack
-    procname*: cstring  ## name of the proc that is currently executing
-    line*: int          ## line number of the proc that is currently executing
-    filename*: cstring  ## filename of the proc that is currently executing
-    len*: int           ## length of the inspectable slots
+when defined(staticframes):
+  type
+    PFrame* = ptr TFrame  ## represents a runtime frame of the call stack;
+                          ## part of the debugger API.
+    TFrame* {.importc, nodecl, final.} = object ## the frame itself
+      prev*: PFrame       ## previous frame; used for chaining the call stack
+      desc: pointer       ## the static descriptor of the proc
+      loc: int            ## index of the current location in the descriptor
+
+  proc procname*(f: PFrame): cstring {.importc: "nimFrameProcname", nodecl.}
+    ## name of the proc that is currently executing
+  proc filename*(f: PFrame): cstring {.importc: "nimFrameFilename", nodecl.}
+    ## filename of the proc that is currently executing
+  proc line*(f: PFrame): int {.importc: "nimFrameLine", nodecl.}
+    ## line number of the proc that is currently executing
+else:
+  type
+    PFrame* = ptr TFrame  ## represents a runtime frame of the call stack;
+                          ## part of the debugger API.
+    TFrame* {.importc, nodecl, final.} = object ## the frame itself
+      prev*: PFrame       ## previous frame; used for chaining the call stack
+      procname*: cstring  ## name of the proc that is currently executing
+      line*: int          ## line number of the proc that is currently executing
+      filename*: cstring  ## filename of the proc that is currently executing
+      len*: int           ## length of the inspectable slots
 
 when defined(JS):
   proc add*(x: var string, y: cstring) {.noStackFrame.} =
@@ -1935,6 +1970,16 @@ when not defined(JS): #and not defined(NimrodVM):
       TFileHandle* = cint ## type that represents an OS file handle; this is
                           ## useful for low-level file access
 
+      TBufferMode* = enum         ## When the buffer of a file is written to
+                                  ## the file; see ``setBufferMode``.
+        bmNone,                   ## Unbuffered: every write goes directly
+                                  ## to the file.
+        bmLine,                   ## Line buffered: the buffer is flushed
+                                  ## after every newline.
+        bmFull                    ## Fully buffered: the buffer is only
+                                  ## flushed when it is full, or by
+                                  ## ``flushFile`` and ``close``.
+
     # text file handling:
     var
       stdin* {.importc: "stdin", header: "<stdio.h>".}: TFile
@@ -1996,6 +2041,13 @@ when not defined(JS): #and not defined(NimrodVM):
       importc: "fflush", header: "<stdio.h>", tags: [FWriteIO].}
       ## Flushes `f`'s buffer.
 
+    proc setBufferMode*(f: TFile, mode: TBufferMode, size = -1) {.tags: [].}
+      ## sets when the buffer of `f` is written to the file and optionally
+      ## its `size`. This has to be called before anything is read from or
+      ## written to `f`. Logging to a file is much faster with ``bmFull``
+      ## than with the ``bmLine`` that the C runtime uses for terminals.
+      ## Raises an IO exception if the mode cannot be set.
+
     proc readAll*(file: TFile): TaintedString {.tags: [FReadIO].}
       ## Reads all data from the stream `file`. Raises an IO exception
       ## in case of an error
@@ -2020,6 +2072,9 @@ when not defined(JS): #and not defined(NimrodVM):
     proc write*(f: TFile, c: cstring) {.tags: [FWriteIO].}
     proc write*(f: TFile, a: varargs[string, `$`]) {.tags: [FWriteIO].}
       ## Writes a value to the file `f`. May throw an IO exception.
+      ## On POSIX and Windows the values of a single ``write`` or
+      ## ``writeln`` call are written under one lock of `f`, so they are not
+      ## interleaved with the output of other threads.
 
     proc readLine*(f: TFile): TaintedString  {.tags: [FReadIO].}
       ## reads a line of text from the file `f`. May throw an IO exception.
@@ -2209,6 +2264,7 @@ when not defined(JS): #and not defined(NimrodVM):
     when hostOS != "standalone": include "system/mmdisp"
     {.push stack_trace: off, profiler:off.}
     when hostOS != "standalone": include "system/sysstr"
+    when hostOS != "standalone": include "system/formatfloat"
     {.pop.}
 
     when hostOS != "standalone": include "system/sysio"
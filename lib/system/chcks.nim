@@ -53,25 +53,56 @@ proc chckNil(p: pointer) =
     sysFatal(EInvalidValue, "attempt to write to a nil address")
     #c_raise(SIGSEGV)
 
+proc isObj(obj, subclass: PNimType): bool {.compilerproc.} =
+  # checks if obj is of type subclass. Every object type with a type field
+  # has a display (see ccgtypes.genObjectInfo), so the subclass test needs
+  # only one lookup:
+  if obj == subclass: return true # optimized fast path
+  if obj != nil:
+    var d = subclass.depth
+    result = d <= obj.depth and obj.display[d] == subclass
+
 proc chckObj(obj, subclass: PNimType) {.compilerproc.} =
   # checks if obj is of type subclass:
-  var x = obj
-  if x == subclass: return # optimized fast path
-  while x != subclass:
-    if x == nil:
-      sysFatal(EInvalidObjectConversion, "invalid object conversion")
-      break
-    x = x.base
+  if not isObj(obj, subclass):
+    sysFatal(EInvalidObjectConversion, "invalid object conversion")
 
 proc chckObjAsgn(a, b: PNimType) {.compilerproc, inline.} =
   if a != b:
     sysFatal(EInvalidObjectAssignment, "invalid object assignment")
 
-proc isObj(obj, subclass: PNimType): bool {.compilerproc.} =
-  # checks if obj is of type subclass:
-  var x = obj
-  if x == subclass: return true # optimized fast path
-  while x != subclass:
-    if x == nil: return false
-    x = x.base
-  return true
+const
+  MethodCacheLen = 64 # must be a power of two
+
+type
+  TMethodCache {.compilerproc, final.} = object
+    # maps the dynamic types of a method call's dispatched arguments to the
+    # index of the override that handles them; every dispatcher has its own
+    a, b: array[0..MethodCacheLen-1, PNimType]
+    slot: array[0..MethodCacheLen-1, int] # index + 1; 0 means unused
+
+proc dynamicType(p: pointer): PNimType {.inline.} =
+  # the type field is always the first field of an object that has one
+  if p != nil: result = cast[ptr PNimType](p)[]
+
+proc methodCacheIndex(a, b: PNimType): int {.inline.} =
+  result = ((cast[int](a) shr 3) xor (cast[int](b) shr 5)) and
+           (MethodCacheLen-1)
+
+proc methodSlot(c: var TMethodCache, a, b: pointer): int {.
+                compilerproc, inline.} =
+  # returns -1 if the dispatcher needs to determine the slot the slow way
+  var ta = dynamicType(a)
+  var tb = dynamicType(b)
+  var h = methodCacheIndex(ta, tb)
+  if c.a[h] == ta and c.b[h] == tb: result = c.slot[h] - 1
+  else: result = -1
+
+proc cacheMethodSlot(c: var TMethodCache, a, b: pointer, slot: int) {.
+                     compilerproc.} =
+  var ta = dynamicType(a)
+  var tb = dynamicType(b)
+  var h = methodCacheIndex(ta, tb)
+  c.a[h] = ta
+  c.b[h] = tb
+  c.slot[h] = slot + 1
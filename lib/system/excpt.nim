@@ -197,16 +197,8 @@ proc quitOrDebug() {.inline.} =
   else:
     endbStep() # call the debugger
 
-proc raiseExceptionAux(e: ref E_Base) =
-  if localRaiseHook != nil:
-    if not localRaiseHook(e): return
-  if globalRaiseHook != nil:
-    if not globalRaiseHook(e): return
-  if excHandler != nil:
-    if not excHandler.hasRaiseAction or excHandler.raiseAction(e):
-      pushCurrentException(e)
-      c_longjmp(excHandler.context, 1)
-  elif e[] of EOutOfMemory:
+proc reportUnhandledException(e: ref E_Base) {.compilerproc.} =
+  if e[] of EOutOfMemory:
     writeToStdErr(e.name)
     quitOrDebug()
   else:
@@ -238,6 +230,24 @@ proc raiseExceptionAux(e: ref E_Base) =
       writeToStdErr(buf)
     quitOrDebug()
 
+proc raiseExceptionAux(e: ref E_Base) =
+  if localRaiseHook != nil:
+    if not localRaiseHook(e): return
+  if globalRaiseHook != nil:
+    if not globalRaiseHook(e): return
+  when defined(zerocostexceptions):
+    # there are no safe points; the C++ runtime finds the handler and
+    # 'NimMain' catches what nobody else does:
+    pushCurrentException(e)
+    {.emit: "throw NimException(`e`, `e`->name);".}
+  else:
+    if excHandler != nil:
+      if not excHandler.hasRaiseAction or excHandler.raiseAction(e):
+        pushCurrentException(e)
+        c_longjmp(excHandler.context, 1)
+    else:
+      reportUnhandledException(e)
+
 proc raiseException(e: ref E_Base, ename: CString) {.compilerRtl.} =
   e.name = ename
   when hasSomeStackTrace:
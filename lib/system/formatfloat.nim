@@ -0,0 +1,242 @@
+#
+#
+#            Nimrod's Runtime Library
+#        (c) Copyright 2013 Andreas Rumpf
+#
+#    See the file "copying.txt", included in this
+#    distribution, for details about the copyright.
+#
+
+# Shortest round-trip formatting of floats. This is the Grisu2 algorithm
+# from Florian Loitsch's "Printing Floating-Point Numbers Quickly and
+# Accurately with Integers". Its output always reads back as the same float
+# and is the shortest such output in almost all cases.
+# The 64 bit significands are unsigned; they are kept in ``int64`` and only
+# processed with ``shr`` and the unsigned operators ``+%``, ``-%``, ``*%``
+# and ``<%``.
+
+type
+  TDiyFp = object  # f * 2^e with a 64 bit significand
+    f: int64
+    e: int
+
+const
+  fpSignificandSize = 52
+  fpHiddenBit = 0x0010000000000000'i64
+  fpSignificandMask = 0x000FFFFFFFFFFFFF'i64
+  fpExponentMask = 0x7FF0000000000000'i64
+  fpExponentBias = 0x3FF + fpSignificandSize
+
+  # 10^k for k = -348, -340, ..., 340 as normalized TDiyFp values:
+  cachedPowersF: array[0..86, int64] = [
+    0xfa8fd5a0081c0288'i64, 0xbaaee17fa23ebf76'i64, 0x8b16fb203055ac76'i64,
+    0xcf42894a5dce35ea'i64, 0x9a6bb0aa55653b2d'i64, 0xe61acf033d1a45df'i64,
+    0xab70fe17c79ac6ca'i64, 0xff77b1fcbebcdc4f'i64, 0xbe5691ef416bd60c'i64,
+    0x8dd01fad907ffc3c'i64, 0xd3515c2831559a83'i64, 0x9d71ac8fada6c9b5'i64,
+    0xea9c227723ee8bcb'i64, 0xaecc49914078536d'i64, 0x823c12795db6ce57'i64,
+    0xc21094364dfb5637'i64, 0x9096ea6f3848984f'i64, 0xd77485cb25823ac7'i64,
+    0xa086cfcd97bf97f4'i64, 0xef340a98172aace5'i64, 0xb23867fb2a35b28e'i64,
+    0x84c8d4dfd2c63f3b'i64, 0xc5dd44271ad3cdba'i64, 0x936b9fcebb25c996'i64,
+    0xdbac6c247d62a584'i64, 0xa3ab66580d5fdaf6'i64, 0xf3e2f893dec3f126'i64,
+    0xb5b5ada8aaff80b8'i64, 0x87625f056c7c4a8b'i64, 0xc9bcff6034c13053'i64,
+    0x964e858c91ba2655'i64, 0xdff9772470297ebd'i64, 0xa6dfbd9fb8e5b88f'i64,
+    0xf8a95fcf88747d94'i64, 0xb94470938fa89bcf'i64, 0x8a08f0f8bf0f156b'i64,
+    0xcdb02555653131b6'i64, 0x993fe2c6d07b7fac'i64, 0xe45c10c42a2b3b06'i64,
+    0xaa242499697392d3'i64, 0xfd87b5f28300ca0e'i64, 0xbce5086492111aeb'i64,
+    0x8cbccc096f5088cc'i64, 0xd1b71758e219652c'i64, 0x9c40000000000000'i64,
+    0xe8d4a51000000000'i64, 0xad78ebc5ac620000'i64, 0x813f3978f8940984'i64,
+    0xc097ce7bc90715b3'i64, 0x8f7e32ce7bea5c70'i64, 0xd5d238a4abe98068'i64,
+    0x9f4f2726179a2245'i64, 0xed63a231d4c4fb27'i64, 0xb0de65388cc8ada8'i64,
+    0x83c7088e1aab65db'i64, 0xc45d1df942711d9a'i64, 0x924d692ca61be758'i64,
+    0xda01ee641a708dea'i64, 0xa26da3999aef774a'i64, 0xf209787bb47d6b85'i64,
+    0xb454e4a179dd1877'i64, 0x865b86925b9bc5c2'i64, 0xc83553c5c8965d3d'i64,
+    0x952ab45cfa97a0b3'i64, 0xde469fbd99a05fe3'i64, 0xa59bc234db398c25'i64,
+    0xf6c69a72a3989f5c'i64, 0xb7dcbf5354e9bece'i64, 0x88fcf317f22241e2'i64,
+    0xcc20ce9bd35c78a5'i64, 0x98165af37b2153df'i64, 0xe2a0b5dc971f303a'i64,
+    0xa8d9d1535ce3b396'i64, 0xfb9b7cd9a4a7443c'i64, 0xbb764c4ca7a44410'i64,
+    0x8bab8eefb6409c1a'i64, 0xd01fef10a657842c'i64, 0x9b10a4e5e9913129'i64,
+    0xe7109bfba19c0c9d'i64, 0xac2820d9623bf429'i64, 0x80444b5e7aa7cf85'i64,
+    0xbf21e44003acdd2d'i64, 0x8e679c2f5e44ff8f'i64, 0xd433179d9c8cb841'i64,
+    0x9e19db92b4e31ba9'i64, 0xeb96bf6ebadf77d9'i64, 0xaf87023b9bf0ee6b'i64]
+  cachedPowersE: array[0..86, int16] = [
+    -1220'i16, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066]
+
+  pow10: array[0..9, int64] = [1'i64, 10, 100, 1000, 10000, 100000, 1000000,
+    10000000, 100000000, 1000000000]
+
+proc mul(x, y: TDiyFp): TDiyFp {.inline.} =
+  # the upper 64 bits of the 128 bit product, rounded
+  const m32 = 0xFFFFFFFF'i64
+  let
+    a = x.f shr 32
+    b = x.f and m32
+    c = y.f shr 32
+    d = y.f and m32
+    ac = a *% c
+    bc = b *% c
+    ad = a *% d
+    bd = b *% d
+  var tmp = (bd shr 32) +% (ad and m32) +% (bc and m32)
+  tmp = tmp +% (1'i64 shl 31)
+  result.f = ac +% (ad shr 32) +% (bc shr 32) +% (tmp shr 32)
+  result.e = x.e + y.e + 64
+
+proc normalize(x: TDiyFp): TDiyFp {.inline.} =
+  result = x
+  while result.f >= 0: # the highest bit is not set yet
+    result.f = result.f shl 1
+    dec(result.e)
+
+proc normalizedBoundaries(v: TDiyFp, mi, pl: var TDiyFp) =
+  # the boundaries halfway to the neighbouring floats of `v`
+  pl.f = (v.f shl 1) +% 1
+  pl.e = v.e - 1
+  while (pl.f and (fpHiddenBit shl 1)) == 0:
+    pl.f = pl.f shl 1
+    dec(pl.e)
+  pl.f = pl.f shl (64 - fpSignificandSize - 2)
+  dec(pl.e, 64 - fpSignificandSize - 2)
+  if v.f == fpHiddenBit:
+    # the lower neighbour of a power of two is closer
+    mi.f = (v.f shl 2) -% 1
+    mi.e = v.e - 2
+  else:
+    mi.f = (v.f shl 1) -% 1
+    mi.e = v.e - 1
+  mi.f = mi.f shl (mi.e - pl.e)
+  mi.e = pl.e
+
+proc cachedPower(e: int, k: var int): TDiyFp =
+  # a power of ten that brings a value with the binary exponent `e` into
+  # the range `digitGen` needs; `k` is its negated decimal exponent
+  let dk = float(-61 - e) * 0.30102999566398114 + 347.0
+  var ki = int(dk)
+  if dk - float(ki) > 0.0: inc(ki)
+  let index = (ki shr 3) + 1
+  k = -(-348 + index * 8)
+  result.f = cachedPowersF[index]
+  result.e = cachedPowersE[index]
+
+proc roundWeed(buf: var openArray[char], len: int,
+               delta, rest, tenKappa, wpW: int64) =
+  # moves the last digit towards the exact value as long as the result
+  # stays within the rounding interval
+  var rest = rest
+  while rest <% wpW and tenKappa <=% delta -% rest and
+      (rest +% tenKappa <% wpW or wpW -% rest >% rest +% tenKappa -% wpW):
+    dec(buf[len-1])
+    rest = rest +% tenKappa
+
+proc countDigits(n: int64): int {.inline.} =
+  result = 1
+  while result < 10 and n >= pow10[result]: inc(result)
+
+proc digitGen(w, mp: TDiyFp, delta: int64, buf: var openArray[char],
+              len, k: var int) =
+  let
+    oneE = -mp.e
+    oneF = 1'i64 shl oneE
+    wpW = mp.f -% w.f
+  var
+    p1 = mp.f shr oneE
+    p2 = mp.f and (oneF -% 1)
+    kappa = countDigits(p1)
+    delta = delta
+  len = 0
+  while kappa > 0:
+    let d = p1 div pow10[kappa-1]
+    p1 = p1 mod pow10[kappa-1]
+    if d != 0 or len != 0:
+      buf[len] = chr(ord('0') + int(d))
+      inc(len)
+    dec(kappa)
+    let tmp = (p1 shl oneE) +% p2
+    if tmp <=% delta:
+      inc(k, kappa)
+      roundWeed(buf, len, delta, tmp, pow10[kappa] shl oneE, wpW)
+      return
+  while true:
+    p2 = p2 *% 10
+    delta = delta *% 10
+    let d = p2 shr oneE
+    if d != 0 or len != 0:
+      buf[len] = chr(ord('0') + int(d))
+      inc(len)
+    p2 = p2 and (oneF -% 1)
+    dec(kappa)
+    if p2 <% delta:
+      inc(k, kappa)
+      roundWeed(buf, len, delta, p2, oneF,
+                if -kappa < 10: wpW *% pow10[-kappa] else: 0'i64)
+      return
+
+proc grisu2(bits: int64, buf: var openArray[char], len, k: var int) =
+  # writes the digits of the positive, finite float with the
+  # representation `bits` to `buf`; its value is ``buf[0..len-1] * 10^k``
+  var w: TDiyFp
+  let biasedE = int((bits and fpExponentMask) shr fpSignificandSize)
+  if biasedE != 0:
+    w.f = (bits and fpSignificandMask) +% fpHiddenBit
+    w.e = biasedE - fpExponentBias
+  else:
+    w.f = bits and fpSignificandMask
+    w.e = 1 - fpExponentBias
+  var mi, pl: TDiyFp
+  normalizedBoundaries(w, mi, pl)
+  let c = cachedPower(pl.e, k)
+  var
+    wp = mul(pl, c)
+    wm = mul(mi, c)
+  wm.f = wm.f +% 1
+  wp.f = wp.f -% 1
+  digitGen(mul(normalize(w), c), wp, wp.f -% wm.f, buf, len, k)
+
+proc addFloat(result: var string, x: float) =
+  let bits = cast[int64](x)
+  let magnitude = bits and (fpExponentMask or fpSignificandMask)
+  if (bits and fpExponentMask) == fpExponentMask:
+    if (bits and fpSignificandMask) != 0: result.add("nan")
+    elif bits < 0: result.add("-inf")
+    else: result.add("inf")
+    return
+  if bits < 0: result.add('-')
+  if magnitude == 0:
+    result.add("0.0")
+    return
+  var
+    buf {.noinit.}: array[0..19, char]
+    len = 0
+    k = 0
+  grisu2(magnitude, buf, len, k)
+  let kk = len + k # the value is in [10^(kk-1), 10^kk)
+  if k >= 0 and kk <= 21:
+    # 1234e7 -> 12340000000.0
+    for i in 0..len-1: result.add(buf[i])
+    for i in 1..k: result.add('0')
+    result.add(".0")
+  elif 0 < kk and kk <= 21:
+    # 1234e-2 -> 12.34
+    for i in 0..kk-1: result.add(buf[i])
+    result.add('.')
+    for i in kk..len-1: result.add(buf[i])
+  elif -6 < kk and kk <= 0:
+    # 1234e-6 -> 0.001234
+    result.add("0.")
+    for i in 1..(-kk): result.add('0')
+    for i in 0..len-1: result.add(buf[i])
+  else:
+    # 1234e30 -> 1.234e33
+    result.add(buf[0])
+    if len > 1:
+      result.add('.')
+      for i in 1..len-1: result.add(buf[i])
+    result.add('e')
+    result.addInt(kk-1)
@@ -65,6 +65,8 @@ type
     tyBigNum,
 
   TNimNodeKind = enum nkNone, nkSlot, nkList, nkCase
+  # the compiler emits TNimNode and TNimType as static initialized data, so
+  # their field order must not change without adapting ccgtypes.nim:
   TNimNode {.codegenType, final.} = object
     kind: TNimNodeKind
     offset: int
@@ -86,6 +88,10 @@ type
     node: ptr TNimNode # valid for tyRecord, tyObject, tyTuple, tyEnum
     finalizer: pointer # the finalizer for the type
     marker: proc (p: pointer, op: int) {.nimcall.} # marker proc for GC
+    depth: int         # number of ancestors; only valid if display != nil
+    display: ptr array [0..0x7fff, ptr TNimType] # valid for every tyObject
+                       # with a type field: the ancestors, root first,
+                       # ending with the type itself
   PNimType = ptr TNimType
   
 # node.len may be the ``first`` element of a set
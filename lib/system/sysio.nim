@@ -45,8 +45,26 @@ proc setvbuf(stream: TFile, buf: pointer, typ, size: cint): cint {.
 proc write(f: TFile, c: cstring) = fputs(c, f)
 {.pop.}
 
+# A sequence of writes takes the lock of the file once; the writes then take
+# the (recursive) lock without contention and other threads cannot
+# interleave their output with ours. No 'try' is used for the unlocking as
+# that is too expensive here; instead the 'writeLocked' procs release the
+# lock before they raise.
+when defined(posix):
+  proc flockfile(f: TFile) {.importc, header: "<stdio.h>", tags: [].}
+  proc funlockfile(f: TFile) {.importc, header: "<stdio.h>", tags: [].}
+elif defined(windows):
+  proc flockfile(f: TFile) {.importc: "_lock_file", header: "<stdio.h>", 
+    tags: [].}
+  proc funlockfile(f: TFile) {.importc: "_unlock_file", header: "<stdio.h>",
+    tags: [].}
+else:
+  proc flockfile(f: TFile) {.inline.} = nil
+  proc funlockfile(f: TFile) {.inline.} = nil
+
 var
   IOFBF {.importc: "_IOFBF", nodecl.}: cint
+  IOLBF {.importc: "_IOLBF", nodecl.}: cint
   IONBF {.importc: "_IONBF", nodecl.}: cint
 
 const
@@ -76,18 +94,29 @@ proc readLine(f: TFile): TaintedString =
   result = TaintedString(newStringOfCap(80))
   if not readLine(f, result): raiseEIO("EOF reached")
 
-proc write(f: TFile, i: int) = 
-  when sizeof(int) == 8:
-    fprintf(f, "%lld", i)
-  else:
-    fprintf(f, "%ld", i)
+proc writeInt(f: TFile, i: biggestInt, locked = false) =
+  # formats `i` into a buffer on the stack and writes it with a single call;
+  # this is much cheaper than letting ``fprintf`` parse a format string.
+  var buf: array[0..31, char]
+  var pos = high(buf)+1
+  var x = i
+  # work with negative numbers so that ``low(biggestInt)`` does not overflow:
+  if x > 0: x = -x
+  while true:
+    dec(pos)
+    buf[pos] = chr(ord('0') - int(x mod 10))
+    x = x div 10
+    if x == 0: break
+  if i < 0:
+    dec(pos)
+    buf[pos] = '-'
+  if writeBuffer(f, addr(buf[pos]), high(buf)+1-pos) != high(buf)+1-pos:
+    if locked: funlockfile(f)
+    raiseEIO("cannot write integer to file")
+
+proc write(f: TFile, i: int) = writeInt(f, i)
+proc write(f: TFile, i: biggestInt) = writeInt(f, i)
 
-proc write(f: TFile, i: biggestInt) = 
-  when sizeof(biggestint) == 8:
-    fprintf(f, "%lld", i)
-  else:
-    fprintf(f, "%ld", i)
-    
 proc write(f: TFile, b: bool) =
   if b: write(f, "true")
   else: write(f, "false")
@@ -95,8 +124,31 @@ proc write(f: TFile, r: float32) = fprintf(f, "%g", r)
 proc write(f: TFile, r: biggestFloat) = fprintf(f, "%g", r)
 
 proc write(f: TFile, c: Char) = putc(c, f)
+
+proc writeLocked(f: TFile, s: string) =
+  if writeBuffer(f, cstring(s), s.len) != s.len:
+    funlockfile(f)
+    raiseEIO("cannot write string to file")
+proc writeLocked(f: TFile, i: int) = writeInt(f, i, true)
+proc writeLocked(f: TFile, i: biggestInt) = writeInt(f, i, true)
+proc writeLocked(f: TFile, b: bool) =
+  if b: writeLocked(f, "true")
+  else: writeLocked(f, "false")
+proc writeLocked[T](f: TFile, x: T) = write(f, x)
+
 proc write(f: TFile, a: varargs[string, `$`]) =
-  for x in items(a): write(f, x)
+  flockfile(f)
+  for x in items(a): writeLocked(f, x)
+  funlockfile(f)
+
+proc setBufferMode(f: TFile, mode: TBufferMode, size = -1) =
+  var s = if size > 0: size else: buf_size
+  var res: cint
+  case mode
+  of bmNone: res = setvbuf(f, nil, IONBF, 0)
+  of bmLine: res = setvbuf(f, nil, IOLBF, s.cint)
+  of bmFull: res = setvbuf(f, nil, IOFBF, s.cint)
+  if res != 0'i32: raiseEIO("cannot set the buffer mode")
 
 proc readAllBuffer(file: TFile): string = 
   # This proc is for TFile we want to read but don't know how many
@@ -156,8 +208,10 @@ proc EndOfFile(f: TFile): bool =
   return c < 0'i32
 
 proc writeln[Ty](f: TFile, x: varargs[Ty, `$`]) =
-  for i in items(x): write(f, i)
-  write(f, "\n")
+  flockfile(f)
+  for i in items(x): writeLocked(f, i)
+  writeLocked(f, "\n")
+  funlockfile(f)
 
 proc rawEcho(x: string) {.inline, compilerproc.} = write(stdout, x)
 proc rawEchoNL() {.inline, compilerproc.} = write(stdout, "\n")
@@ -232,47 +232,59 @@ proc setLengthSeq(seq: PGenericSeq, elemSize, newLen: int): PGenericSeq {.
   result.len = newLen
 
 # --------------- other string routines ----------------------------------
-proc nimIntToStr(x: int): string {.compilerRtl.} =
-  result = newString(sizeof(x)*4)
-  var i = 0
-  var y = x
-  while True:
-    var d = y div 10
-    result[i] = chr(abs(int(y - d*10)) + ord('0'))
-    inc(i)
-    y = d
-    if y == 0: break
+const
+  digitPairs = # "00" .. "99"; two digits per division halve the divisions
+    "0001020304050607080910111213141516171819" &
+    "2021222324252627282930313233343536373839" &
+    "4041424344454647484950515253545556575859" &
+    "6061626364656667686970717273747576777879" &
+    "8081828384858687888990919293949596979899"
+
+proc intToDigits(buf: var array[0..19, char], x: int64): int =
+  # writes the digits of `x` without the sign to the end of `buf` and
+  # returns the position of the first digit. The digits are produced from
+  # the negative value as ``-low(int64)`` does not exist.
+  result = high(buf)+1
+  var y = if x > 0: -x else: x
+  while y <= -100:
+    let q = y div 100
+    let r = int(q * 100 - y) * 2
+    dec(result, 2)
+    buf[result] = digitPairs[r]
+    buf[result+1] = digitPairs[r+1]
+    y = q
+  if y <= -10:
+    let r = int(-y) * 2
+    dec(result, 2)
+    buf[result] = digitPairs[r]
+    buf[result+1] = digitPairs[r+1]
+  else:
+    dec(result)
+    buf[result] = chr(ord('0') - int(y))
+
+proc addInt(result: var string, x: int64) =
+  var buf {.noinit.}: array[0..19, char]
+  let first = intToDigits(buf, x)
+  var i = result.len
+  setLen(result, i + high(buf)+1 - first + ord(x < 0))
   if x < 0:
     result[i] = '-'
     inc(i)
-  setLen(result, i)
-  # mirror the string:
-  for j in 0..i div 2 - 1:
-    swap(result[j], result[i-j-1])
+  copyMem(addr(result[i]), addr(buf[first]), high(buf)+1 - first)
+
+proc nimInt64ToStr(x: int64): string {.compilerRtl.} =
+  result = newStringOfCap(sizeof(x)*3)
+  addInt(result, x)
+
+proc nimIntToStr(x: int): string {.compilerRtl.} =
+  result = newStringOfCap(sizeof(x)*3)
+  addInt(result, x)
 
 proc nimFloatToStr(x: float): string {.compilerproc.} =
   var buf: array [0..59, char]
   c_sprintf(buf, "%#.16e", x)
   return $buf
 
-proc nimInt64ToStr(x: int64): string {.compilerRtl.} =
-  result = newString(sizeof(x)*4)
-  var i = 0
-  var y = x
-  while True:
-    var d = y div 10
-    result[i] = chr(abs(int(y - d*10)) + ord('0'))
-    inc(i)
-    y = d
-    if y == 0: break
-  if x < 0:
-    result[i] = '-'
-    inc(i)
-  setLen(result, i)
-  # mirror the string:
-  for j in 0..i div 2 - 1:
-    swap(result[j], result[i-j-1])
-
 proc nimBoolToStr(x: bool): string {.compilerRtl.} =
   return if x: "true" else: "false"
 
@@ -0,0 +1,33 @@
+# Measures the throughput of the compiler's lexer in tokens per second.
+# Run it from the root of the repository:
+#   nimrod c -d:release -r tests/benchmarks/lexbench.nim lib
+
+import os, times, strutils
+import "../../compiler/llstream", "../../compiler/lexer"
+
+proc lexFile(filename: string): int =
+  var stream = LLStreamOpen(filename, fmRead)
+  if stream == nil: return 0
+  var L: TLexer
+  var tok: TToken
+  initToken(tok)
+  openLexer(L, filename, stream)
+  while true:
+    rawGetTok(L, tok)
+    inc result
+    if tok.tokType == tkEof: break
+  closeLexer(L)
+
+var dir = if paramCount() > 0: paramStr(1) else: "lib"
+var files: seq[string] = @[]
+for f in walkDirRec(dir):
+  if f.endsWith(".nim"): files.add(f)
+
+const rounds = 10
+var tokens = 0
+let t0 = epochTime()
+for i in 1..rounds:
+  for f in files: inc(tokens, lexFile(f))
+let t = epochTime() - t0
+echo "files: ", files.len, " tokens: ", tokens div rounds
+echo "tokens/sec: ", formatFloat(tokens.float / t, ffDecimal, 0)
@@ -0,0 +1,44 @@
+# Compares the scalar matrix product with the one of basic3d which uses
+# the simd module. Compile with -d:release.
+
+import times, basic3d
+
+proc scalarMul(a, b: TMatrix3d): TMatrix3d =
+  result = matrix3d(
+    a.aw*b.tx+a.az*b.cx+a.ay*b.bx+a.ax*b.ax,
+    a.aw*b.ty+a.az*b.cy+a.ay*b.by+a.ax*b.ay,
+    a.aw*b.tz+a.az*b.cz+a.ay*b.bz+a.ax*b.az,
+    a.aw*b.tw+a.az*b.cw+a.ay*b.bw+a.ax*b.aw,
+
+    a.bw*b.tx+a.bz*b.cx+a.by*b.bx+a.bx*b.ax,
+    a.bw*b.ty+a.bz*b.cy+a.by*b.by+a.bx*b.ay,
+    a.bw*b.tz+a.bz*b.cz+a.by*b.bz+a.bx*b.az,
+    a.bw*b.tw+a.bz*b.cw+a.by*b.bw+a.bx*b.aw,
+
+    a.cw*b.tx+a.cz*b.cx+a.cy*b.bx+a.cx*b.ax,
+    a.cw*b.ty+a.cz*b.cy+a.cy*b.by+a.cx*b.ay,
+    a.cw*b.tz+a.cz*b.cz+a.cy*b.bz+a.cx*b.az,
+    a.cw*b.tw+a.cz*b.cw+a.cy*b.bw+a.cx*b.aw,
+
+    a.tw*b.tx+a.tz*b.cx+a.ty*b.bx+a.tx*b.ax,
+    a.tw*b.ty+a.tz*b.cy+a.ty*b.by+a.tx*b.ay,
+    a.tw*b.tz+a.tz*b.cz+a.ty*b.bz+a.tx*b.az,
+    a.tw*b.tw+a.tz*b.cw+a.ty*b.bw+a.tx*b.aw)
+
+const iterations = 10_000_000
+
+var
+  step = rotate(0.001, vector3d(1.0, 1.0, 2.5)) & move(0.5, 0.25, 0.125)
+  m1 = IDMATRIX
+  m2 = IDMATRIX
+
+var t0 = cpuTime()
+for i in 1..iterations: m1 = scalarMul(m1, step)
+echo "scalar: ", cpuTime() - t0
+
+t0 = cpuTime()
+for i in 1..iterations: m2 = m2 & step
+echo "simd:   ", cpuTime() - t0
+
+# both versions add in the same order and thus agree exactly:
+echo equals(m1, m2, 0.0)
@@ -0,0 +1,49 @@
+# Measures the cost of entering 'try' statements that do not raise.
+# Compare 'nimrod c -d:release' with 'nimrod cpp -d:release' (which uses
+# --exceptions:zerocost by default).
+
+import times
+
+const iterations = 50_000_000
+
+var
+  counter = 0
+  closed = 0
+
+proc work(i: int) {.noinline.} =
+  if i < 0: raise newException(EInvalidValue, "negative")
+  inc counter
+
+proc tryExcept() =
+  for i in 0 .. <iterations:
+    try:
+      work(i)
+    except EInvalidValue:
+      dec counter
+
+proc tryFinally() =
+  for i in 0 .. <iterations:
+    try:
+      work(i)
+    finally:
+      inc closed
+
+proc raising() =
+  for i in 0 .. <iterations div 100:
+    try:
+      work(-1)
+    except EInvalidValue:
+      inc closed
+
+var t0 = cpuTime()
+tryExcept()
+echo "try/except:  ", cpuTime() - t0
+
+t0 = cpuTime()
+tryFinally()
+echo "try/finally: ", cpuTime() - t0
+
+t0 = cpuTime()
+raising()
+echo "raising:     ", cpuTime() - t0
+echo counter, " ", closed
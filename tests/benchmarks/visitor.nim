@@ -0,0 +1,336 @@
+# Dispatch benchmark: a visitor over an AST with 50 node classes.
+# Compile with ``--methodDispatch:ifchain`` to compare against the old
+# dispatchers.
+
+import times
+
+type
+  PNode = ref object of TObject
+    kids: seq[PNode]
+  PNode0 = ref object of PNode
+  PNode1 = ref object of PNode
+  PNode2 = ref object of PNode
+  PNode3 = ref object of PNode
+  PNode4 = ref object of PNode
+  PNode5 = ref object of PNode
+  PNode6 = ref object of PNode
+  PNode7 = ref object of PNode
+  PNode8 = ref object of PNode
+  PNode9 = ref object of PNode
+  PNode10 = ref object of PNode
+  PNode11 = ref object of PNode
+  PNode12 = ref object of PNode
+  PNode13 = ref object of PNode
+  PNode14 = ref object of PNode
+  PNode15 = ref object of PNode
+  PNode16 = ref object of PNode
+  PNode17 = ref object of PNode
+  PNode18 = ref object of PNode
+  PNode19 = ref object of PNode
+  PNode20 = ref object of PNode
+  PNode21 = ref object of PNode
+  PNode22 = ref object of PNode
+  PNode23 = ref object of PNode
+  PNode24 = ref object of PNode
+  PNode25 = ref object of PNode
+  PNode26 = ref object of PNode
+  PNode27 = ref object of PNode
+  PNode28 = ref object of PNode
+  PNode29 = ref object of PNode
+  PNode30 = ref object of PNode
+  PNode31 = ref object of PNode
+  PNode32 = ref object of PNode
+  PNode33 = ref object of PNode
+  PNode34 = ref object of PNode
+  PNode35 = ref object of PNode
+  PNode36 = ref object of PNode
+  PNode37 = ref object of PNode
+  PNode38 = ref object of PNode
+  PNode39 = ref object of PNode
+  PNode40 = ref object of PNode
+  PNode41 = ref object of PNode
+  PNode42 = ref object of PNode
+  PNode43 = ref object of PNode
+  PNode44 = ref object of PNode
+  PNode45 = ref object of PNode
+  PNode46 = ref object of PNode
+  PNode47 = ref object of PNode
+  PNode48 = ref object of PNode
+  PNode49 = ref object of PNode
+  PVisitor = ref object of TObject
+    count: int
+
+method visit(v: PVisitor, n: PNode) = quit "to override!"
+method visit(v: PVisitor, n: PNode0) = inc(v.count, 1)
+method visit(v: PVisitor, n: PNode1) = inc(v.count, 2)
+method visit(v: PVisitor, n: PNode2) = inc(v.count, 3)
+method visit(v: PVisitor, n: PNode3) = inc(v.count, 4)
+method visit(v: PVisitor, n: PNode4) = inc(v.count, 5)
+method visit(v: PVisitor, n: PNode5) = inc(v.count, 6)
+method visit(v: PVisitor, n: PNode6) = inc(v.count, 7)
+method visit(v: PVisitor, n: PNode7) = inc(v.count, 8)
+method visit(v: PVisitor, n: PNode8) = inc(v.count, 9)
+method visit(v: PVisitor, n: PNode9) = inc(v.count, 10)
+method visit(v: PVisitor, n: PNode10) = inc(v.count, 11)
+method visit(v: PVisitor, n: PNode11) = inc(v.count, 12)
+method visit(v: PVisitor, n: PNode12) = inc(v.count, 13)
+method visit(v: PVisitor, n: PNode13) = inc(v.count, 14)
+method visit(v: PVisitor, n: PNode14) = inc(v.count, 15)
+method visit(v: PVisitor, n: PNode15) = inc(v.count, 16)
+method visit(v: PVisitor, n: PNode16) = inc(v.count, 17)
+method visit(v: PVisitor, n: PNode17) = inc(v.count, 18)
+method visit(v: PVisitor, n: PNode18) = inc(v.count, 19)
+method visit(v: PVisitor, n: PNode19) = inc(v.count, 20)
+method visit(v: PVisitor, n: PNode20) = inc(v.count, 21)
+method visit(v: PVisitor, n: PNode21) = inc(v.count, 22)
+method visit(v: PVisitor, n: PNode22) = inc(v.count, 23)
+method visit(v: PVisitor, n: PNode23) = inc(v.count, 24)
+method visit(v: PVisitor, n: PNode24) = inc(v.count, 25)
+method visit(v: PVisitor, n: PNode25) = inc(v.count, 26)
+method visit(v: PVisitor, n: PNode26) = inc(v.count, 27)
+method visit(v: PVisitor, n: PNode27) = inc(v.count, 28)
+method visit(v: PVisitor, n: PNode28) = inc(v.count, 29)
+method visit(v: PVisitor, n: PNode29) = inc(v.count, 30)
+method visit(v: PVisitor, n: PNode30) = inc(v.count, 31)
+method visit(v: PVisitor, n: PNode31) = inc(v.count, 32)
+method visit(v: PVisitor, n: PNode32) = inc(v.count, 33)
+method visit(v: PVisitor, n: PNode33) = inc(v.count, 34)
+method visit(v: PVisitor, n: PNode34) = inc(v.count, 35)
+method visit(v: PVisitor, n: PNode35) = inc(v.count, 36)
+method visit(v: PVisitor, n: PNode36) = inc(v.count, 37)
+method visit(v: PVisitor, n: PNode37) = inc(v.count, 38)
+method visit(v: PVisitor, n: PNode38) = inc(v.count, 39)
+method visit(v: PVisitor, n: PNode39) = inc(v.count, 40)
+method visit(v: PVisitor, n: PNode40) = inc(v.count, 41)
+method visit(v: PVisitor, n: PNode41) = inc(v.count, 42)
+method visit(v: PVisitor, n: PNode42) = inc(v.count, 43)
+method visit(v: PVisitor, n: PNode43) = inc(v.count, 44)
+method visit(v: PVisitor, n: PNode44) = inc(v.count, 45)
+method visit(v: PVisitor, n: PNode45) = inc(v.count, 46)
+method visit(v: PVisitor, n: PNode46) = inc(v.count, 47)
+method visit(v: PVisitor, n: PNode47) = inc(v.count, 48)
+method visit(v: PVisitor, n: PNode48) = inc(v.count, 49)
+method visit(v: PVisitor, n: PNode49) = inc(v.count, 50)
+
+proc walk(v: PVisitor, n: PNode) =
+  visit(v, n)
+  for k in items(n.kids): walk(v, k)
+
+proc newNode(kind: int): PNode =
+  case kind
+  of 0:
+    var x: PNode0
+    new(x)
+    result = x
+  of 1:
+    var x: PNode1
+    new(x)
+    result = x
+  of 2:
+    var x: PNode2
+    new(x)
+    result = x
+  of 3:
+    var x: PNode3
+    new(x)
+    result = x
+  of 4:
+    var x: PNode4
+    new(x)
+    result = x
+  of 5:
+    var x: PNode5
+    new(x)
+    result = x
+  of 6:
+    var x: PNode6
+    new(x)
+    result = x
+  of 7:
+    var x: PNode7
+    new(x)
+    result = x
+  of 8:
+    var x: PNode8
+    new(x)
+    result = x
+  of 9:
+    var x: PNode9
+    new(x)
+    result = x
+  of 10:
+    var x: PNode10
+    new(x)
+    result = x
+  of 11:
+    var x: PNode11
+    new(x)
+    result = x
+  of 12:
+    var x: PNode12
+    new(x)
+    result = x
+  of 13:
+    var x: PNode13
+    new(x)
+    result = x
+  of 14:
+    var x: PNode14
+    new(x)
+    result = x
+  of 15:
+    var x: PNode15
+    new(x)
+    result = x
+  of 16:
+    var x: PNode16
+    new(x)
+    result = x
+  of 17:
+    var x: PNode17
+    new(x)
+    result = x
+  of 18:
+    var x: PNode18
+    new(x)
+    result = x
+  of 19:
+    var x: PNode19
+    new(x)
+    result = x
+  of 20:
+    var x: PNode20
+    new(x)
+    result = x
+  of 21:
+    var x: PNode21
+    new(x)
+    result = x
+  of 22:
+    var x: PNode22
+    new(x)
+    result = x
+  of 23:
+    var x: PNode23
+    new(x)
+    result = x
+  of 24:
+    var x: PNode24
+    new(x)
+    result = x
+  of 25:
+    var x: PNode25
+    new(x)
+    result = x
+  of 26:
+    var x: PNode26
+    new(x)
+    result = x
+  of 27:
+    var x: PNode27
+    new(x)
+    result = x
+  of 28:
+    var x: PNode28
+    new(x)
+    result = x
+  of 29:
+    var x: PNode29
+    new(x)
+    result = x
+  of 30:
+    var x: PNode30
+    new(x)
+    result = x
+  of 31:
+    var x: PNode31
+    new(x)
+    result = x
+  of 32:
+    var x: PNode32
+    new(x)
+    result = x
+  of 33:
+    var x: PNode33
+    new(x)
+    result = x
+  of 34:
+    var x: PNode34
+    new(x)
+    result = x
+  of 35:
+    var x: PNode35
+    new(x)
+    result = x
+  of 36:
+    var x: PNode36
+    new(x)
+    result = x
+  of 37:
+    var x: PNode37
+    new(x)
+    result = x
+  of 38:
+    var x: PNode38
+    new(x)
+    result = x
+  of 39:
+    var x: PNode39
+    new(x)
+    result = x
+  of 40:
+    var x: PNode40
+    new(x)
+    result = x
+  of 41:
+    var x: PNode41
+    new(x)
+    result = x
+  of 42:
+    var x: PNode42
+    new(x)
+    result = x
+  of 43:
+    var x: PNode43
+    new(x)
+    result = x
+  of 44:
+    var x: PNode44
+    new(x)
+    result = x
+  of 45:
+    var x: PNode45
+    new(x)
+    result = x
+  of 46:
+    var x: PNode46
+    new(x)
+    result = x
+  of 47:
+    var x: PNode47
+    new(x)
+    result = x
+  of 48:
+    var x: PNode48
+    new(x)
+    result = x
+  of 49:
+    var x: PNode49
+    new(x)
+    result = x
+  else: quit "unknown node kind"
+  result.kids = @[]
+
+proc buildTree(depth: int, seed: var int): PNode =
+  seed = (seed * 75 + 74) mod 65537
+  result = newNode(seed mod 50)
+  if depth > 0:
+    for i in 0..3: result.kids.add(buildTree(depth-1, seed))
+
+var seed = 42
+var root = buildTree(7, seed)
+var v: PVisitor
+new(v)
+var t0 = epochTime()
+for i in 0..99: walk(v, root)
+echo "count: ", v.count, " time: ", epochTime() - t0
@@ -0,0 +1,36 @@
+discard """
+  outputsub: "no leak: "
+"""
+# Tests that the refcount-free moves and swaps of refs keep the counts right
+
+type
+  PNode = ref TNode
+  TNode = object
+    next: PNode
+    data: array[0..15, int]
+
+  PQueue = ref TQueue
+  TQueue = object
+    head, spare: PNode
+
+proc inProc() =
+  var q: PQueue
+  new(q)
+  for i in 1 .. 1_000_000:
+    when defined(gcMarkAndSweep):
+      GC_fullcollect()
+    var n: PNode
+    new(n)
+    n.data[0] = i
+    q.spare = n
+    q.head = q.spare
+    q.spare = nil
+    swap(q.head, q.spare)
+    swap(q.head, q.spare)
+    if q.spare != nil or q.head.data[0] != i: quit("wrong move")
+    q.head.next = q.head
+    q.head.next = nil
+    if getOccupiedMem() > 300_000: quit("still a leak!")
+
+inProc()
+echo "no leak: ", getOccupiedMem()
@@ -0,0 +1,37 @@
+discard """
+  file: "tcaselower.nim"
+  output: "vvcvd11200 0 1 1 2 3 4 4 5 5 6 -1 -1"
+"""
+# Test the bit test and binary search tree translations of 'case'
+
+proc vowel(c: char): char =
+  case c
+  of 'a', 'e', 'i', 'o', 'u': result = 'v'
+  of '0'..'9': result = 'd'
+  else: result = 'c'
+
+proc letter(c: char): int =
+  case c
+  of 'a', 'e': result = 1
+  of 'x'..'z': result = 2
+  else: result = 0
+
+proc classify(x: int): int =
+  case x
+  of 1..10: result = 0
+  of 100, 200: result = 1
+  of 1000..2000: result = 2
+  of 5000: result = 3
+  of 10_000..10_010, 20_000: result = 4
+  of 65_000..66_000: result = 5
+  of 1_000_000: result = 6
+  else: result = -1
+
+var s = ""
+for c in items("aecu7"): s.add(vowel(c))
+for c in items("aeybq"): s.add($letter(c))
+for x in items([5, 100, 200, 1500, 5000, 10_005, 20_000, 65_000, 66_000,
+                1_000_000, 0, 3000]):
+  s.add(' ')
+  s.add($classify(x))
+echo s
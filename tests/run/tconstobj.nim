@@ -0,0 +1,31 @@
+discard """
+  output: '''3 5 bc y
+7 1 true
+0 true'''
+"""
+# Test object constructors that are emitted as static data
+
+type
+  TBase = object of TObject
+    name: string
+  TPoint = object of TBase
+    x, y: int
+    tags: seq[string]
+  TEmpty = object
+
+let points = [TPoint(name: "a", x: 1, y: 2, tags: @["x", "y"]),
+              TPoint(name: "b", x: 3)]
+
+var p = points[1]
+p.x = 5
+p.name.add("c")
+echo points[1].x, " ", p.x, " ", p.name, " ", points[0].tags[1]
+
+proc isPoint(b: TBase): bool = b of TPoint
+
+let q = TPoint(name: "q", y: 7)
+echo q.y, " ", q.name.len, " ", isPoint(q)
+
+var e = TEmpty()
+var r = TPoint()
+echo r.x, " ", isNil(r.name)
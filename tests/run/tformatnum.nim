@@ -0,0 +1,35 @@
+discard """
+  output: '''0 -7 42 -9223372036854775808 9223372036854775807
+0.1 1.0 -2.0 123456.789 1e21 100000000000000000000.0
+0.000123 2.5e-7 5e-324 1.7976931348623157e308 inf nan
+true'''
+"""
+# Test appending numbers to strings
+
+import strutils, math
+
+var s = ""
+for x in [0'i64, -7, 42, low(int64), high(int64)]:
+  if s.len > 0: s.add(' ')
+  s.addInt(x)
+echo s
+
+proc floats(a: openArray[float]): string =
+  result = ""
+  for x in a:
+    if result.len > 0: result.add(' ')
+    result.addFloat(x)
+
+echo floats([0.1, 1.0, -2.0, 123456.789, 1e21, 1e20])
+echo floats([0.000123, 2.5e-7, 5e-324, 1.7976931348623157e308, inf, nan])
+
+proc strtod(s: cstring, endp: pointer = nil): float {.
+  importc, header: "<stdlib.h>".}
+
+# every float reads back unchanged:
+randomize()
+var ok = true
+for i in 1..10_000:
+  let x = random(1.0) * pow(10.0, float(random(600) - 300))
+  if strtod(formatFloat(x, ffShortest)) != x: ok = false
+echo ok
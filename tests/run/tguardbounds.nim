@@ -0,0 +1,55 @@
+discard """
+  file: "tguardbounds.nim"
+  output: "6 6 c ? -1 caught caught"
+"""
+# Test that index checks proven by guards are elided and stale guards are not
+# trusted
+
+proc get(a: seq[int], i: int): int =
+  if i >= 0 and i < a.len: result = a[i]
+  else: result = -1
+
+proc sum(a: openarray[int]): int =
+  var i: natural = 0
+  while i < a.len:
+    inc(result, a[i])
+    inc(i)
+
+proc at(s: string, i: int): char =
+  if i < 0 or i >= s.len: return '?'
+  result = s[i]
+
+proc stale(i: int): int =
+  var a = @[1, 2, 3]
+  if i >= 0 and i < a.len:
+    a.setLen(1)
+    result = a[i]
+
+type
+  PHolder = ref THolder
+  THolder = object
+    s: seq[int]
+
+proc clear(o: PHolder) {.noSideEffect.} = o.s.setLen(0)
+
+proc staleShared(o: PHolder, x: seq[int], i: int): int =
+  # 'x' shares its buffer with 'o.s' which 'clear' shrinks through the ref
+  if i >= 0 and i < x.len:
+    clear(o)
+    result = x[i]
+
+var s = @[1, 2, 3]
+var o = $(get(s, 2) * 2) & " " & $sum(s) & " " & at("abc", 2) & " " &
+        at("abc", 5) & " " & $get(s, 3)
+try:
+  discard stale(2)
+except EInvalidIndex:
+  o.add(" caught")
+var h: PHolder
+new(h)
+h.s = @[1, 2, 3]
+try:
+  discard staleShared(h, h.s, 1)
+except EInvalidIndex:
+  o.add(" caught")
+echo o
@@ -0,0 +1,53 @@
+discard """
+  file: "tloopbounds.nim"
+  output: "6 18 abc 3 caught caught"
+"""
+# Test the loops whose index checks are proven once per loop
+
+proc mul(a: var seq[float], b, c: seq[float]) =
+  for i in 0..high(a): a[i] = b[i] * c[i]
+
+proc sum(a: openarray[float]): float =
+  for i in countup(0, len(a)-1): result = result + a[i]
+
+proc upper(s: string): string =
+  result = s
+  for i in 0..high(s):
+    if s[i] in {'A'..'Z'}: result[i] = chr(ord(s[i]) + 32)
+
+proc shrink(a: var seq[int]): int =
+  for i in 0..high(a):
+    if i == 1: a.setLen(1)
+    result = result + a[i]
+
+type
+  PHolder = ref THolder
+  THolder = object
+    s: seq[int]
+
+proc clear(o: PHolder) {.noSideEffect.} = o.s.setLen(0)
+
+proc useAfterClear(o: PHolder, x: seq[int]): int =
+  # 'x' shares its buffer with 'o.s'; 'clear' has no side effect but still
+  # shrinks it through the ref
+  for i in 0..high(x):
+    clear(o)
+    result = result + x[i]
+
+var a = @[0.0, 0.0, 0.0]
+mul(a, @[1.0, 2.0, 3.0], @[2.0, 2.0, 4.0])
+var x = @[1, 2, 3]
+var msg = "not caught"
+try:
+  discard shrink(x)
+except EInvalidIndex:
+  msg = "caught"
+var h: PHolder
+new(h)
+h.s = @[1, 2, 3]
+var msg2 = "not caught"
+try:
+  discard useAfterClear(h, h.s)
+except EInvalidIndex:
+  msg2 = "caught"
+echo int(a[0] + a[1]), " ", int(sum(a)), " ", upper("AbC"), " ", len(a), " ", msg, " ", msg2
@@ -0,0 +1,27 @@
+discard """
+  output: '''3 [ab] [] [c d]
+true'''
+"""
+# Test the line iterator of memory mapped files
+
+import memfiles, os
+
+const filename = "tmemlines.txt"
+writeFile(filename, "ab\r\n\nc d")
+
+var f = memfiles.open(filename)
+f.advise(maSequential)
+var count = 0
+var s = ""
+for line in lines(f):
+  inc(count)
+  s.add(" [" & $line & "]")
+f.close()
+echo count, s
+
+var g = memfiles.open(filename, flags = {mfPopulate})
+var total = 0
+for line in lines(g, eat = '\0'): inc(total, line.size)
+g.close()
+echo total == 6
+removeFile(filename)
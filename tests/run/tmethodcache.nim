@@ -0,0 +1,43 @@
+discard """
+  file: "tmethodcache.nim"
+  output: "ABCBA AB BA AA AB BA AA"
+"""
+# Test that the cached method dispatch picks the same overrides as the
+# if chain, also for repeated calls that are served from the cache
+
+type
+  PNode = ref object of TObject
+  PA = ref object of PNode
+  PB = ref object of PA
+  PC = ref object of PB
+
+method name(n: PNode): string = "?"
+method name(n: PA): string = "A"
+method name(n: PB): string = "B"
+method name(n: PC): string = "C"
+
+method meet(a, b: PNode): string = "?"
+method meet(a: PA, b: PB): string = "AB"
+method meet(a: PB, b: PA): string = "BA"
+method meet(a, b: PA): string = "AA"
+
+var
+  a: PA
+  b: PB
+  c: PC
+new(a)
+new(b)
+new(c)
+
+var nodes: seq[PNode] = @[]
+nodes.add(a)
+nodes.add(b)
+nodes.add(c)
+nodes.add(b)
+nodes.add(a)
+
+var s = ""
+for n in items(nodes): s.add(name(n))
+for i in 0..1:
+  s.add(" " & meet(a, b) & " " & meet(b, a) & " " & meet(a, a))
+echo s
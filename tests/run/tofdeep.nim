@@ -0,0 +1,36 @@
+discard """
+  file: "tofdeep.nim"
+  output: "truetruefalsefalsetruefalse caught"
+"""
+# Test 'of' and checked conversions on a deep hierarchy; these are
+# answered by the ancestor display of the type info
+
+type
+  TA = object of TObject
+  TB = object of TA
+  TC = object of TB
+  TD = object of TC
+  TE = object of TD
+  TSide = object of TB
+  PC = ref TC
+
+var
+  e: ref TE
+  s: ref TSide
+  a: ref TA
+new(e)
+new(s)
+
+a = e
+write(stdout, a of TC)
+write(stdout, a of TA)
+write(stdout, a of TSide)
+a = s
+write(stdout, a of TC)
+write(stdout, a of TB)
+write(stdout, a of TE)
+try:
+  var c = PC(a)
+  echo " not caught"
+except EInvalidObjectConversion:
+  echo " caught"
@@ -0,0 +1,39 @@
+discard """
+  file: "tsimd.nim"
+  output: "30 [1, 2, 2, 2] [4, 3, 2, 1] 26 -2 7 true [3, 3, 7, 7]"
+"""
+# Test the lane operations of the simd module
+
+import simd
+
+var
+  a = vec4f32(1.0, 2.0, 3.0, 4.0)
+  b = splat4f32(2.0)
+
+var s = ""
+s.add($int(sum(a * b + a)))
+
+let m = select(cmpLt(a, b), a, b)
+s.add(" [")
+for i in 0..3:
+  if i > 0: s.add(", ")
+  s.add($int(m[i]))
+s.add("] ")
+
+var x = vec4i32(1, 2, 3, 4)
+s.add($shuffle(x, [3, 2, 1, 0]))
+
+var buf = [0'i64, 5, 6, 7, 8, 0]
+var y: TVec4i64
+y.load(buf, 1)
+s.add(" " & $(sum(y)))
+s.add(" " & $(min(y - splat4i64(7))))
+s.add(" " & $(max(y and splat4i64(7))))
+
+y += splat4i64(1)
+y.store(buf, 2)
+s.add(" " & $(buf[2] == 6 and buf[5] == 9 and buf[1] == 5))
+
+let c = max(vec4i32(1, 3, 5, 7), vec4i32(3, 2, 7, 6))
+s.add(" " & $(min(c, splat4i32(7))))
+echo s
@@ -0,0 +1,29 @@
+discard """
+  file: "tsimdheap.nim"
+  output: "48 72 3"
+"""
+# Test vectors in seqs and ref objects, which are not aligned to the vector
+# size
+
+import simd
+
+type
+  PBox = ref TBox
+  TBox = object
+    tag: char
+    v: TVec8f32
+    w: TVec4f32
+
+var s: seq[TVec4f32] = @[]
+for i in 0..2: s.add(splat4f32(float32(i+1)))
+var acc = splat4f32(0.0)
+for v in items(s): acc = acc + v * splat4f32(2.0)
+let x = int(sum(acc))
+
+var b: PBox
+new(b)
+b.tag = 'x'
+b.v = vec8f32(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0)
+b.v = b.v + b.v
+b.w = s[2]
+echo x, " ", int(sum(b.v)), " ", int(b.w[0])
@@ -0,0 +1,40 @@
+discard """
+  file: "tsinkmove.nim"
+  output: "abc abc abx 0123 012 3"
+"""
+# Test that moves of strings and seqs keep value semantics
+
+type
+  TBuilder = object
+    data: seq[int]
+
+proc setData(b: var TBuilder, data {.sink.}: seq[int]) =
+  b.data = data
+
+proc build(n: int): seq[int] =
+  var s: seq[int] = @[]
+  for i in 0 .. <n: s.add(i)
+  result = s
+
+proc moved(): string =
+  var a = "ab"
+  a.add('c')
+  var b = a
+  result = b
+
+proc copied(): string =
+  var a = "ab"
+  var b = a
+  b.add('x')
+  result = a & 'c' & " " & b
+
+var b: TBuilder
+var live = build(3)
+b.setData(live)
+live.add(3)
+
+proc str(s: seq[int]): string =
+  result = ""
+  for x in s: result.add($x)
+
+echo moved(), " ", copied(), " ", str(live), " ", str(b.data), " ", build(4)[3]
@@ -0,0 +1,38 @@
+discard """
+  file: "tstackalloc.nim"
+  output: "30 7 7 3"
+"""
+# Test that objects of non-escaping refs work when put on the stack
+
+type
+  TPoint = object of TObject
+    x, y: int
+  PPoint = ref TPoint
+  T3D = object of TPoint
+    z: int
+  P3D = ref T3D
+
+var keep: PPoint
+
+proc sumLocal(n: int): int =
+  var p: PPoint
+  for i in 1..n:
+    new(p)
+    p.x = i
+    p.y = p.x * 2
+    result = result + p.x + p.y
+
+proc escaping(n: int): int =
+  var p: PPoint
+  new(p)
+  p.x = n
+  keep = p
+  result = keep.x
+
+proc zeroed(): int =
+  var q: P3D
+  new(q)
+  q.z = 3
+  if not isNil(q): result = q.z + q.x + q.y
+
+echo sumLocal(4), " ", escaping(7), " ", keep.x, " ", zeroed()
@@ -0,0 +1,26 @@
+discard """
+  file: "tstaticframes.nim"
+  cmd: "nimrod cc --staticFrames:on --stackTrace:on --lineTrace:on --hints:on $# $#"
+  output: "true true true true"
+"""
+# Test stack traces built from static frame descriptors
+
+import strutils
+
+var trace = ""
+
+proc inner(x: int): int =
+  if x > 2:
+    trace = getStackTrace()
+  result = x * 2
+
+proc outer(): int =
+  for i in 1..3:
+    result = inner(i)
+
+discard outer()
+
+echo trace.contains("tstaticframes.nim(14)"), " ",
+     trace.contains("tstaticframes.nim(19)"), " ",
+     trace.contains("tstaticframes.nim(21)"), " ",
+     trace.contains("inner")
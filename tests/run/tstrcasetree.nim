@@ -0,0 +1,27 @@
+discard """
+  file: "tstrcasetree.nim"
+  output: "0 1 2 3 4 5 6 7 8 9 10 -1 -1 -1"
+"""
+# Test the length and character based code for big string case statements
+
+proc verb(s: string): int =
+  case s
+  of "GET": result = 0
+  of "PUT": result = 1
+  of "POST": result = 2
+  of "HEAD": result = 3
+  of "DELETE": result = 4
+  of "OPTIONS": result = 5
+  of "TRACE": result = 6
+  of "CONNECT": result = 7
+  of "PATCH": result = 8
+  of "PATCHES", "PATCHED": result = 9
+  of "": result = 10
+  else: result = -1
+
+var s = ""
+for x in items(["GET", "PUT", "POST", "HEAD", "DELETE", "OPTIONS", "TRACE",
+                "CONNECT", "PATCH", "PATCHED", "", "GOT", "PATCHE", "PUTS"]):
+  if s.len > 0: s.add(' ')
+  s.add($verb(x))
+echo s
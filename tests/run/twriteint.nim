@@ -0,0 +1,14 @@
+discard """
+  output: '''0 -7 1234567890
+-9223372036854775808 9223372036854775807'''
+"""
+# Test writing integers to files
+
+setBufferMode(stdout, bmFull)
+write(stdout, 0, " ", -7, " ", 1234567890)
+writeln(stdout, "")
+stdout.write(low(biggestInt))
+stdout.write(' ')
+stdout.write(high(biggestInt))
+stdout.write("\n")
+flushFile(stdout)
@@ -0,0 +1,44 @@
+discard """
+  file: "tzerocost.nim"
+  cmd: "nimrod cpp --exceptions:zerocost --hints:on $# $#"
+  output: "io:disk full fin index ret:fin 3 outer:again"
+"""
+# Test exceptions implemented with C++ 'try' and 'throw'
+
+var s = ""
+
+proc fail() = raise newException(EIO, "disk full")
+
+try:
+  fail()
+except EOS:
+  s.add("os")
+except EIO:
+  s.add("io:" & getCurrentExceptionMsg())
+finally:
+  s.add(" fin")
+
+var a = @[1, 2]
+var i = 5
+try:
+  a[i] = 3
+except EInvalidIndex:
+  s.add(" index")
+
+proc withReturn(): int =
+  try:
+    return 3
+  finally:
+    s.add(" ret:fin")
+
+s.add(" " & $withReturn())
+
+try:
+  try:
+    raise newException(EInvalidValue, "again")
+  except EInvalidValue:
+    raise
+except EInvalidValue:
+  s.add(" outer:" & getCurrentExceptionMsg())
+
+echo s
@@ -132,6 +132,7 @@ proc runGcTests(r: var TResults, options: string) =
   test "weakrefs"
   test "cycleleak"
   test "closureleak"
+  test "refmove"
 
 # ------------------------- threading tests -----------------------------------
 
@@ -11,16 +11,21 @@
 
 import
   parseutils, strutils, pegs, os, osproc, streams, parsecfg, browsers, json,
-  marshal, cgi, parseopt, caasdriver
+  marshal, cgi, parseopt, caasdriver, tables, hashes, md5, algorithm
 
 const
   cmdTemplate = r"nimrod cc --hints:on $# $#"
   resultsFile = "testresults.html"
   jsonFile = "testresults.json"
-  Usage = "usage: tester [--print] " &
+  cacheFile = "testcache.json"
+  Usage = "usage: tester [--print] [--jobs:N] [--shard:I/N] [--cache] " &
                     "reject|compile|run|" &
                     "merge|special|rodfiles| [nimrod options]\n" &
-          "   or: tester test|comp|rej singleTest"
+          "   or: tester test|comp|rej singleTest\n" &
+          "  --jobs:N      run N compilers in parallel (0: one per processor)\n" &
+          "  --shard:I/N   only run the I-th of N parts of the tests\n" &
+          "  --cache       skip the tests that passed with the same test file,\n" &
+          "                compiler and options before"
 
 type
   TTestAction = enum
@@ -55,6 +60,16 @@ type
     total, passed, skipped: int
     data: string
 
+var
+  gJobs = 1             # how many compilers run in parallel
+  gShard = 0            # this process runs the tests of shard `gShard`
+  gShardCount = 1       # out of `gShardCount` shards
+  gUseCache = false
+  gCache = initTable[string, string]() # test -> key of its last pass
+  gCompilerHash = ""
+  gPrecompiled = initTable[string, TSpec]() # command -> compiler result
+  gNimcaches = initTable[string, string]() # test -> its own nimcache
+
 # ----------------------- Spec parser ----------------------------------------
 
 when not defined(parseCfgBool):
@@ -132,21 +147,14 @@ let
   pegSuccess = peg"'Hint: operation successful'.*"
   pegOfInterest = pegLineError / pegOtherError
 
-proc callCompiler(cmdTemplate, filename, options: string): TSpec =
-  let c = parseCmdLine(cmdTemplate % [options, filename])
-  var p = startProcess(command=c[0], args=c[1.. -1],
-                       options={poStdErrToStdOut, poUseShell})
-  let outp = p.outputStream
-  var suc = ""
-  var err = ""
-  var x = newStringOfCap(120)
-  while outp.readLine(x.TaintedString) or running(p):
-    if x =~ pegOfInterest:
-      # `err` should contain the last error/warning message
-      err = x
-    elif x =~ pegSuccess:
-      suc = x
-  close(p)
+proc scanOutputLine(x: string, err, suc: var string) =
+  if x =~ pegOfInterest:
+    # `err` should contain the last error/warning message
+    err = x
+  elif x =~ pegSuccess:
+    suc = x
+
+proc compilerResult(err, suc: string): TSpec =
   result.msg = ""
   result.file = ""
   result.outp = ""
@@ -160,6 +168,94 @@ proc callCompiler(cmdTemplate, filename, options: string): TSpec =
   elif suc =~ pegSuccess:
     result.err = reSuccess
 
+proc callCompiler(cmdTemplate, filename, options: string): TSpec =
+  let cmd = cmdTemplate % [options, filename]
+  if gPrecompiled.hasKey(cmd): return gPrecompiled[cmd]
+  let c = parseCmdLine(cmd)
+  var p = startProcess(command=c[0], args=c[1.. -1],
+                       options={poStdErrToStdOut, poUseShell})
+  let outp = p.outputStream
+  var suc = ""
+  var err = ""
+  var x = newStringOfCap(120)
+  while outp.readLine(x.TaintedString) or running(p):
+    scanOutputLine(x, err, suc)
+  close(p)
+  result = compilerResult(err, suc)
+
+proc cacheKey(test, options: string): string =
+  result = getMD5(readFile(test).string & "\0" & options & "\0" & 
+                  gCompilerHash)
+
+proc loadCache() =
+  let exe = findExe("nimrod")
+  if exe.len > 0: gCompilerHash = getMD5(readFile(exe).string)
+  if existsFile(cacheFile):
+    for test, key in pairs(parseFile(cacheFile)):
+      gCache[test] = key.str
+
+proc isCached(test, options: string): bool =
+  result = gUseCache and gCache.hasKey(test) and 
+           gCache[test] == cacheKey(test, options)
+
+proc saveCache() =
+  var doc = newJObject()
+  for test, key in pairs(gCache): doc[test] = newJString(key)
+  writeFile(cacheFile, pretty(doc))
+
+proc precompile(tests: seq[string], options: string, useSpec: bool) =
+  ## runs the compiler for `tests` with `gJobs` processes in parallel; 
+  ## ``callCompiler`` then picks up the results. Every test gets its own
+  ## nimcache so that the compilers do not overwrite each other's files.
+  if gJobs <= 1: return
+  var jobs: seq[tuple[cmd, key, log: string]] = @[]
+  for test in items(tests):
+    if isCached(test, options): continue
+    var cmd = cmdTemplate
+    if useSpec:
+      let spec = parseSpec(test)
+      if spec.err == reIgnored: continue
+      cmd = spec.cmd
+    let (dir, name, ext) = splitFile(test)
+    let nimcache = dir / "nimcache" / name
+    createDir(nimcache)
+    gNimcaches[test] = nimcache
+    jobs.add((cmd % [options & " --nimcache:" & nimcache, test] &
+              " > " & quoteIfContainsWhite(nimcache / "compiler.log") & 
+              " 2>&1", cmd % [options, test], nimcache / "compiler.log"))
+  var running: seq[tuple[p: PProcess, job: int]] = @[]
+  var next = 0
+  while next < jobs.len or running.len > 0:
+    while running.len < gJobs and next < jobs.len:
+      running.add((startCmd(jobs[next].cmd, options={poUseShell}), next))
+      inc(next)
+    var i = 0
+    while i < running.len:
+      if peekExitCode(running[i].p) == -1: 
+        inc(i)
+        continue
+      close(running[i].p)
+      let job = jobs[running[i].job]
+      var suc = ""
+      var err = ""
+      var outp = newFileStream(job.log, fmRead)
+      if outp != nil:
+        var x = newStringOfCap(120)
+        while outp.readLine(x.TaintedString): scanOutputLine(x, err, suc)
+        outp.close()
+      gPrecompiled[job.key] = compilerResult(err, suc)
+      running.del(i)
+    sleep(10)
+
+proc selectTests(pattern: string): seq[string] =
+  ## the tests matching `pattern` that belong to this process' shard. The
+  ## shard only depends on the test's name so that all machines agree on it.
+  result = @[]
+  for test in os.walkFiles(pattern):
+    if (hash(test.replace('\\', '/')) and high(int)) mod gShardCount == gShard:
+      result.add(test)
+  sort(result, system.cmp)
+
 proc initResults: TResults =
   result.total = 0
   result.passed = 0
@@ -172,6 +268,25 @@ proc readResults(filename: string): TResults =
 proc writeResults(filename: string, r: TResults) =
   writeFile(filename, $$r)
 
+proc shardFile(filename: string): string =
+  ## the results of the shards are kept apart until they are merged
+  if gShardCount <= 1: result = filename
+  else: result = filename.changeFileExt("") & "." & $gShard & ".json"
+
+proc readMerged(filename: string): TResults =
+  ## reads the results of an unsharded run and of all shards
+  result = initResults()
+  var files: seq[string] = @[]
+  if existsFile(filename): files.add(filename)
+  for f in walkFiles(filename.changeFileExt("") & ".*.json"): files.add(f)
+  sort(files, system.cmp)
+  for f in items(files):
+    let x = readResults(f)
+    inc(result.total, x.total)
+    inc(result.passed, x.passed)
+    inc(result.skipped, x.skipped)
+    result.data.add(x.data)
+
 proc `$`(x: TResults): string =
   result = ("Tests passed: $1 / $3 <br />\n" &
             "Tests skipped: $2 / $3 <br />\n") %
@@ -216,6 +331,21 @@ proc addResult(r: var TResults, test, given: string,
   r.data.addf("<tr><td>$#</td><td>$#</td><td>$#</td></tr>\n", [
     XMLEncode(test), td(given), success.colorResult])
 
+template cachedTest(r: var TResults, test, options: string, 
+                    threeColumns: bool, body: stmt) {.immediate.} =
+  ## runs `body` unless `test` passed before with the same inputs
+  if isCached(test, options):
+    inc(r.total)
+    inc(r.passed)
+    if threeColumns: r.addResult(extractFilename(test), "cached", reSuccess)
+    else: r.addResult(extractFilename(test), "", "cached", reSuccess)
+  else:
+    let passed = r.passed
+    body
+    if gUseCache:
+      if r.passed > passed: gCache[test] = cacheKey(test, options)
+      else: gCache.del(test)
+
 proc listResults(reject, compile, run: TResults) =
   var s = HtmlBegin
   s.add("<h1>Tests to Reject</h1>\n")
@@ -257,14 +387,20 @@ proc rejectSingleTest(r: var TResults, test, options: string) =
 
 proc reject(r: var TResults, dir, options: string) =
   ## handle all the tests that the compiler should reject
-  for test in os.walkFiles(dir / "t*.nim"): rejectSingleTest(r, test, options)
+  let tests = selectTests(dir / "t*.nim")
+  precompile(tests, options, useSpec=true)
+  for test in items(tests): 
+    cachedTest(r, test, options, false):
+      rejectSingleTest(r, test, options)
 
 proc codegenCheck(test, check, ext: string, given: var TSpec) =
   if check.len > 0:
     try:
       let (path, name, ext2) = test.splitFile
-      echo path / "nimcache" / name.changeFileExt(ext)
-      let contents = readFile(path / "nimcache" / name.changeFileExt(ext)).string
+      var nimcache = path / "nimcache"
+      if gNimcaches.hasKey(test): nimcache = gNimcaches[test]
+      echo nimcache / name.changeFileExt(ext)
+      let contents = readFile(nimcache / name.changeFileExt(ext)).string
       if contents.find(check.peg) < 0:
         given.err = reCodegenFailure
     except EInvalidValue:
@@ -276,20 +412,23 @@ proc codegenChecks(test: string, expected: TSpec, given: var TSpec) =
   codegenCheck(test, expected.ccodeCheck, ".c", given)
   
 proc compile(r: var TResults, pattern, options: string) =
-  for test in os.walkFiles(pattern):
-    let t = extractFilename(test)
-    echo t
-    inc(r.total)
-    let expected = parseSpec(test)
-    if expected.err == reIgnored:
-      r.addResult(t, "", reIgnored)
-      inc(r.skipped)
-    else:
-      var given = callCompiler(expected.cmd, test, options)
-      if given.err == reSuccess:
-        codegenChecks(test, expected, given)
-      r.addResult(t, given.msg, given.err)
-      if given.err == reSuccess: inc(r.passed)
+  let tests = selectTests(pattern)
+  precompile(tests, options, useSpec=true)
+  for test in items(tests):
+    cachedTest(r, test, options, true):
+      let t = extractFilename(test)
+      echo t
+      inc(r.total)
+      let expected = parseSpec(test)
+      if expected.err == reIgnored:
+        r.addResult(t, "", reIgnored)
+        inc(r.skipped)
+      else:
+        var given = callCompiler(expected.cmd, test, options)
+        if given.err == reSuccess:
+          codegenChecks(test, expected, given)
+        r.addResult(t, given.msg, given.err)
+        if given.err == reSuccess: inc(r.passed)
 
 proc compileSingleTest(r: var TResults, test, options: string) =
   # does not extract the spec because the file is not supposed to have any
@@ -343,12 +482,20 @@ proc runSingleTest(r: var TResults, test, options: string) =
   runSingleTest(r, test, options, targetC)
 
 proc run(r: var TResults, dir, options: string) =
-  for test in os.walkFiles(dir / "t*.nim"): runSingleTest(r, test, options)
+  let tests = selectTests(dir / "t*.nim")
+  precompile(tests, options, useSpec=true)
+  for test in items(tests):
+    cachedTest(r, test, options, false):
+      runSingleTest(r, test, options)
 
 include specials
 
 proc compileExample(r: var TResults, pattern, options: string) =
-  for test in os.walkFiles(pattern): compileSingleTest(r, test, options)
+  let tests = selectTests(pattern)
+  precompile(tests, options, useSpec=false)
+  for test in items(tests):
+    cachedTest(r, test, options, true):
+      compileSingleTest(r, test, options)
 
 proc toJson(res: TResults): PJsonNode =
   result = newJObject()
@@ -381,11 +528,22 @@ proc main() =
   var optPrintResults = false
   var p = initOptParser()
   p.next()
-  if p.kind == cmdLongoption:
-    case p.key.string
+  while p.kind == cmdLongoption:
+    case p.key.string.normalize
     of "print": optPrintResults = true
+    of "jobs":
+      gJobs = parseInt(p.val.string)
+      if gJobs <= 0: gJobs = countProcessors()
+    of "shard":
+      let parts = p.val.string.split('/')
+      if parts.len != 2: quit usage
+      gShard = parseInt(parts[0])
+      gShardCount = parseInt(parts[1])
+      if gShard < 0 or gShard >= gShardCount: quit usage
+    of "cache": gUseCache = true
     else: quit usage
     p.next()
+  if gUseCache: loadCache()
   if p.kind != cmdArgument: quit usage
   var action = p.key.string.normalize
   p.next()
@@ -393,8 +551,9 @@ proc main() =
   case action
   of "reject":
     reject(r, "tests/reject", p.cmdLineRest.string)
-    rejectSpecialTests(r, p.cmdLineRest.string)
-    writeResults(rejectJson, r)
+    # the special tests are not split up:
+    if gShard == 0: rejectSpecialTests(r, p.cmdLineRest.string)
+    writeResults(shardFile(rejectJson), r)
   of "compile":
     compile(r, "tests/compile/t*.nim", p.cmdLineRest.string)
     compile(r, "tests/ccg/t*.nim", p.cmdLineRest.string)
@@ -403,12 +562,13 @@ proc main() =
     compileExample(r, "examples/*.nim", p.cmdLineRest.string)
     compileExample(r, "examples/gtk/*.nim", p.cmdLineRest.string)
     compileExample(r, "examples/talk/*.nim", p.cmdLineRest.string)
-    compileSpecialTests(r, p.cmdLineRest.string)
-    writeResults(compileJson, r)
+    # the special tests are not split up:
+    if gShard == 0: compileSpecialTests(r, p.cmdLineRest.string)
+    writeResults(shardFile(compileJson), r)
   of "run":
     run(r, "tests/run", p.cmdLineRest.string)
-    runSpecialTests(r, p.cmdLineRest.string)
-    writeResults(runJson, r)
+    if gShard == 0: runSpecialTests(r, p.cmdLineRest.string)
+    writeResults(shardFile(runJson), r)
   of "special":
     runSpecialTests(r, p.cmdLineRest.string)
     runCaasTests(r)
@@ -422,9 +582,9 @@ proc main() =
     runJsTests(r, p.cmdLineRest.string)
     writeResults(runJson, r)
   of "merge":
-    var rejectRes = readResults(rejectJson)
-    var compileRes = readResults(compileJson)
-    var runRes = readResults(runJson)
+    var rejectRes = readMerged(rejectJson)
+    var compileRes = readMerged(compileJson)
+    var runRes = readMerged(runJson)
     listResults(rejectRes, compileRes, runRes)
     outputJSON(rejectRes, compileRes, runRes)
   of "dll":
@@ -450,6 +610,7 @@ proc main() =
     quit usage
 
   if optPrintResults: echo r, r.data
+  if gUseCache: saveCache()
 
 if paramCount() == 0:
   quit usage
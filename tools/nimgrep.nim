@@ -8,7 +8,7 @@
 #
 
 import
-  os, strutils, parseopt, pegs, re, terminal
+  os, strutils, parseopt, pegs, re, terminal, memfiles, tables, osproc
 
 const
   Version = "0.9"
@@ -33,10 +33,15 @@ Options:
   --ignoreStyle, -y   be style insensitive
   --ext:EX1|EX2|...   only search the files with the given extension(s)
   --nocolor           output will be given without any colours.
+  --jobs:N            search N files in parallel (default: the number of
+                      processors); replacing always uses a single thread
   --verbose           be verbose: list every processed file
   --help, -h          shows this help
   --version, -v       shows the version
+Binary files (files with a zero byte in their first 4KB) are skipped.
 """
+  alignment = 6         # width of the line numbers
+  binaryCheckSize = 4096 # how many bytes are checked for binary files
 
 type
   TOption = enum 
@@ -45,14 +50,24 @@ type
   TOptions = set[TOption]
   TConfirmEnum = enum 
     ceAbort, ceYes, ceAll, ceNo, ceNone
+  TMatch = tuple[line: int, before, match, after: string]
+  TWorkItem = tuple[id: int, filename, pattern, literal: string]
+  TFileResult = tuple[id: int, filename: string, error: bool,
+                      matches: seq[TMatch]]
+  TReadResult = enum
+    rrRead, rrSkipped, rrFailed
     
 var
   filenames: seq[string] = @[]
   pattern = ""
   replacement = ""
+  literal = ""          # a part of every match; used to skip files quickly
   extensions: seq[string] = @[]
   options: TOptions = {optRegex}
   useWriteStyled = true
+  jobs = 0
+  pegp: TPeg            # the compiled pattern of the main thread
+  rep: TRegex
 
 proc ask(msg: string): string =
   stdout.write(msg)
@@ -100,7 +115,6 @@ proc writeColored(s: string) =
 
 proc highlight(s, match, repl: string, t: tuple[first, last: int],
                line: int, showRepl: bool) = 
-  const alignment = 6
   stdout.write(line.`$`.align(alignment), ": ")
   var x = beforePattern(s, t.first)
   var y = afterPattern(s, t.last)
@@ -115,7 +129,96 @@ proc highlight(s, match, repl: string, t: tuple[first, last: int],
     for i in t.last+1 .. y: stdout.write(s[i])
     stdout.write("\n")
 
-proc processFile(filename: string) =
+proc compilePattern(pattern: string, pegp: var TPeg, rep: var TRegex) =
+  if optRegex in options:
+    if {optIgnoreCase, optIgnoreStyle} * options != {}:
+      rep = re(pattern, {reExtended, reIgnoreCase})
+    else:
+      rep = re(pattern)
+  else:
+    pegp = peg(pattern)
+
+proc containsLiteral(s: cstring, len: int, lit: string): bool =
+  var i = 0
+  while i <= len - lit.len:
+    if s[i] == lit[0]:
+      var j = 1
+      while j < lit.len and s[i+j] == lit[j]: inc(j)
+      if j == lit.len: return true
+    inc(i)
+
+proc mayMatch(s: cstring, len: int, literal: string): bool =
+  # binary files and files without the literal part of the pattern are
+  # skipped before the pattern runs:
+  for i in 0 .. min(len, binaryCheckSize)-1:
+    if s[i] == '\0': return false
+  result = literal.len == 0 or containsLiteral(s, len, literal)
+
+proc readCandidate(filename, literal: string, buffer: var string): TReadResult =
+  var f: TMemFile
+  try:
+    f = memfiles.open(filename)
+  except EOS:
+    # empty files and special files cannot be mapped:
+    try:
+      buffer = system.readFile(filename)
+    except EIO:
+      return rrFailed
+    if mayMatch(buffer, buffer.len, literal): return rrRead
+    return rrSkipped
+  # only the files that may match are copied out of the mapping:
+  if mayMatch(cast[cstring](f.mem), f.size, literal):
+    buffer = newString(f.size)
+    if f.size > 0: copyMem(addr(buffer[0]), f.mem, f.size)
+    result = rrRead
+  else:
+    result = rrSkipped
+  close(f)
+
+proc searchFile(item: TWorkItem, pegp: TPeg, rep: TRegex): TFileResult =
+  result.id = item.id
+  result.filename = item.filename
+  result.matches = @[]
+  var buffer: string
+  case readCandidate(item.filename, item.literal, buffer)
+  of rrFailed: 
+    result.error = true
+    return
+  of rrSkipped: return
+  of rrRead: nil
+  var line = 1
+  var i = 0
+  var matches: array[0..re.MaxSubpatterns-1, string]
+  for j in 0..high(matches): matches[j] = ""
+  while i < buffer.len:
+    var t: tuple[first, last: int]
+    if optRegex notin options:
+      t = findBounds(buffer, pegp, matches, i)
+    else:
+      t = findBounds(buffer, rep, matches, i)
+    if t.first < 0: break
+    inc(line, countLines(buffer, i, t.first-1))
+    var x = beforePattern(buffer, t.first)
+    var y = afterPattern(buffer, t.last)
+    result.matches.add((line, buffer.substr(x, t.first-1), 
+                        buffer.substr(t.first, t.last), 
+                        buffer.substr(t.last+1, y)))
+    # an empty match must not stop the progress:
+    var last = max(t.last, t.first)
+    inc(line, countLines(buffer, t.first, last))
+    i = last+1
+
+proc printResult(r: TFileResult) =
+  if r.error:
+    echo "cannot open file: ", r.filename
+    return
+  if optVerbose in options or r.matches.len > 0: stdout.writeln(r.filename)
+  for m in items(r.matches):
+    stdout.write(m.line.`$`.align(alignment), ": ", m.before)
+    writeColored(m.match)
+    stdout.write(m.after, "\n")
+
+proc replaceInFile(filename: string) =
   var filenameShown = false
   template beforeHighlight =
     if not filenameShown and optVerbose notin options: 
@@ -129,20 +232,7 @@ proc processFile(filename: string) =
     echo "cannot open file: ", filename
     return
   if optVerbose in options: stdout.writeln(filename)
-  var pegp: TPeg
-  var rep: TRegex
-  var result: string
-
-  if optRegex in options:
-    if {optIgnoreCase, optIgnoreStyle} * options != {}:
-      rep = re(pattern, {reExtended, reIgnoreCase})
-    else:
-      rep = re(pattern)
-  else:
-    pegp = peg(pattern)
-    
-  if optReplace in options:
-    result = newStringOfCap(buffer.len)
+  var result = newStringOfCap(buffer.len)
     
   var line = 1
   var i = 0
@@ -155,51 +245,208 @@ proc processFile(filename: string) =
       t = findBounds(buffer, pegp, matches, i)
     else:
       t = findBounds(buffer, rep, matches, i)
-    if t.first <= 0: break
+    if t.first < 0: break
     inc(line, countLines(buffer, i, t.first-1))
     
     var wholeMatch = buffer.substr(t.first, t.last)
     
     beforeHighlight()
-    if optReplace notin options: 
-      highlight(buffer, wholeMatch, "", t, line, showRepl=false)
+    var r: string
+    if optRegex notin options:
+      r = replace(wholeMatch, pegp, replacement % matches)
+    else: 
+      r = replace(wholeMatch, rep, replacement % matches)
+    if optConfirm in options: 
+      highlight(buffer, wholeMatch, r, t, line, showRepl=true)
+      case Confirm()
+      of ceAbort: quit(0)
+      of ceYes: reallyReplace = true 
+      of ceAll: 
+        reallyReplace = true
+        options.excl(optConfirm)
+      of ceNo:
+        reallyReplace = false
+      of ceNone:
+        reallyReplace = false
+        options.excl(optConfirm)
     else:
-      var r: string
-      if optRegex notin options:
-        r = replace(wholeMatch, pegp, replacement % matches)
-      else: 
-        r = replace(wholeMatch, rep, replacement % matches)
-      if optConfirm in options: 
-        highlight(buffer, wholeMatch, r, t, line, showRepl=true)
-        case Confirm()
-        of ceAbort: quit(0)
-        of ceYes: reallyReplace = true 
-        of ceAll: 
-          reallyReplace = true
-          options.excl(optConfirm)
-        of ceNo:
-          reallyReplace = false
-        of ceNone:
-          reallyReplace = false
-          options.excl(optConfirm)
-      else:
-        highlight(buffer, wholeMatch, r, t, line, showRepl=reallyReplace)
-      if reallyReplace:
-        result.add(buffer.substr(i, t.first-1))
-        result.add(r)
-      else:
-        result.add(buffer.substr(i, t.last))
+      highlight(buffer, wholeMatch, r, t, line, showRepl=reallyReplace)
+    if reallyReplace:
+      result.add(buffer.substr(i, t.first-1))
+      result.add(r)
+    else:
+      result.add(buffer.substr(i, t.last))
+
+    var last = max(t.last, t.first)
+    inc(line, countLines(buffer, t.first, last))
+    if last > t.last: result.add(buffer.substr(t.last+1, last))
+    i = last+1
+  result.add(substr(buffer, i))
+  var f: TFile
+  if open(f, filename, fmWrite):
+    f.write(result)
+    f.close()
+  else:
+    quit "cannot open file for overwriting: " & filename
 
-    inc(line, countLines(buffer, t.first, t.last))
-    i = t.last+1
+when compileOption("threads"):
+  var
+    workQueue: TChannel[TWorkItem]
+    resultQueue: TChannel[TFileResult]
+    workers: seq[TThread[int]]
+
+  proc worker(dummy: int) {.thread.} =
+    var pegp: TPeg
+    var rep: TRegex
+    var compiled = false
+    while true:
+      var item = recv(workQueue)
+      if isNil(item.filename): break
+      if not compiled:
+        compilePattern(item.pattern, pegp, rep)
+        compiled = true
+      send(resultQueue, searchFile(item, pegp, rep))
+
+var
+  nextId = 0            # the id of the next file to search
+  printedId = 0         # the results of the files before it are printed
+  pending = initTable[int, TFileResult]()
+
+proc useThreads(): bool {.inline.} =
+  result = compileOption("threads") and jobs > 1 and optReplace notin options
+
+proc addResult(r: TFileResult) =
+  # the results are printed in the order in which the files were found:
+  pending[r.id] = r
+  while pending.hasKey(printedId):
+    printResult(pending[printedId])
+    pending.del(printedId)
+    inc(printedId)
+
+proc processFile(filename: string) =
   if optReplace in options:
-    result.add(substr(buffer, i))
-    var f: TFile
-    if open(f, filename, fmWrite):
-      f.write(result)
-      f.close()
+    replaceInFile(filename)
+    return
+  var item: TWorkItem = (nextId, filename, pattern, literal)
+  inc(nextId)
+  when compileOption("threads"):
+    if useThreads():
+      send(workQueue, item)
+      # keep the number of files in flight (and their results) bounded:
+      while nextId - printedId > 64 * jobs: addResult(recv(resultQueue))
+      while peek(resultQueue) > 0: addResult(recv(resultQueue))
+      return
+  printResult(searchFile(item, pegp, rep))
+
+proc startWorkers() =
+  when compileOption("threads"):
+    if useThreads():
+      open(workQueue)
+      open(resultQueue)
+      newSeq(workers, jobs)
+      for i in 0 .. jobs-1: createThread(workers[i], worker, i)
+
+proc stopWorkers() =
+  when compileOption("threads"):
+    if useThreads():
+      var stop: TWorkItem # a nil filename stops a worker
+      stop.id = -1
+      for i in 0 .. jobs-1: send(workQueue, stop)
+      while printedId < nextId: addResult(recv(resultQueue))
+      joinThreads(workers)
+      close(workQueue)
+      close(resultQueue)
+
+proc regexLiteral(pattern: string): string =
+  # extracts the longest run of characters that every match of the extended
+  # regular expression `pattern` contains. Alternatives make this too hard,
+  # and the contents of groups and character classes are ignored. Inline
+  # options like ``(?i)`` may change what matches, so they disable this.
+  result = ""
+  if '|' in pattern or find(pattern, "(?") >= 0: return
+  var run = ""
+  var i = 0
+  var depth = 0
+  template endRun =
+    if run.len > result.len: result = run
+    run = ""
+  while i < pattern.len:
+    var c = pattern[i]
+    case c
+    of ' ', '\t', '\c', '\L':
+      inc(i)
+      continue
+    of '#': break # a comment
+    of '\\':
+      if i+1 < pattern.len and pattern[i+1] notin Letters+Digits: 
+        c = pattern[i+1]
+        inc(i, 2)
+      else:
+        # skip the whole escape sequence: \x41, \x{263a}, \p{Lu}, \pL,
+        # \cX, \Q...\E, octal escapes and back references like \k<name>
+        endRun()
+        inc(i)
+        var e = if i < pattern.len: pattern[i] else: '\0'
+        inc(i)
+        if e == 'Q':
+          while i < pattern.len and not (pattern[i] == '\\' and
+              i+1 < pattern.len and pattern[i+1] == 'E'): inc(i)
+          inc(i, 2)
+        elif i < pattern.len and pattern[i] == '{':
+          while i < pattern.len and pattern[i] != '}': inc(i)
+          inc(i)
+        elif e in {'x', 'X'}:
+          var k = 0
+          while k < 2 and i < pattern.len and pattern[i] in HexDigits:
+            inc(i)
+            inc(k)
+        elif e in {'k', 'g'} and i < pattern.len and pattern[i] == '<':
+          while i < pattern.len and pattern[i] != '>': inc(i)
+          inc(i)
+        elif e in {'p', 'P', 'c'}: inc(i)
+        elif e in Digits:
+          while i < pattern.len and pattern[i] in Digits: inc(i)
+        continue
+    of '[':
+      # skip the character class; ']' is a member if it comes first
+      inc(i)
+      if i < pattern.len and pattern[i] == '^': inc(i)
+      if i < pattern.len and pattern[i] == ']': inc(i)
+      while i < pattern.len and pattern[i] != ']':
+        if pattern[i] == '\\': inc(i)
+        inc(i)
+      inc(i)
+      endRun()
+      continue
+    of '(', ')':
+      if c == '(': inc(depth) 
+      else: dec(depth)
+      inc(i)
+      endRun()
+      continue
+    of '{':
+      # a counted quantifier; its digits are not part of any match
+      while i < pattern.len and pattern[i] != '}': inc(i)
+      inc(i)
+      endRun()
+      continue
+    of '.', '^', '$', '*', '+', '?', '}':
+      inc(i)
+      endRun()
+      continue
+    else: inc(i)
+    # the quantifier that follows decides whether `c` is needed:
+    var j = i
+    while j < pattern.len and pattern[j] in Whitespace: inc(j)
+    var q = if j < pattern.len: pattern[j] else: '\0'
+    if depth > 0 or q in {'*', '?', '{'}:
+      endRun()
+    elif q == '+':
+      run.add(c)
+      endRun()
     else:
-      quit "cannot open file for overwriting: " & filename
+      run.add(c)
+  endRun()
 
 proc hasRightExt(filename: string, exts: seq[string]): bool =
   var y = splitFile(filename).ext.substr(1) # skip leading '.'
@@ -293,6 +540,7 @@ for kind, key, val in getopt():
     of "ignorestyle", "y": incl(options, optIgnoreStyle)
     of "ext": extensions = val.split('|')
     of "nocolor": useWriteStyled = false
+    of "jobs", "j": jobs = parseInt(val)
     of "verbose": incl(options, optVerbose)
     of "help", "h": writeHelp()
     of "version", "v": writeVersion()
@@ -317,6 +565,8 @@ if pattern.len == 0:
 else: 
   if filenames.len == 0: 
     filenames.add(os.getCurrentDir())
+  if optRegex in options and {optIgnoreCase, optIgnoreStyle} * options == {}:
+    literal = regexLiteral(pattern)
   if optRegex notin options: 
     if optWord in options:
       pattern = r"(^ / !\letter)(" & pattern & r") !\letter"
@@ -329,6 +579,10 @@ else:
       pattern = styleInsensitive(pattern)
     if optWord in options:
       pattern = r"\b (:?" & pattern & r") \b"
+  compilePattern(pattern, pegp, rep)
+  if jobs <= 0: jobs = countProcessors()
+  startWorkers()
   for f in items(filenames):
     walker(f)
+  stopWorkers()
 